@@ -0,0 +1,136 @@
+/*
+*
+* This file contains a benchmark comparing the binary BVH and the compressed 8-wide BVH used by the
+* CPU implementation of GeneratePRT. For each, the memory used and the number of visibility rays
+* traced per second on a single thread are printed, using the same rays as GeneratePRT: cosine
+* weighted directions about the normal of randomly chosen vertices.
+*
+* The path to a .obj file may be given as the first argument, otherwise Bunny.obj is used. The
+* differences are largest for meshes with millions of triangles, whose hierarchy does not fit in the
+* cache. Unlike the other demos, this does not require DirectX12 and so can also be run on Linux.
+*
+*
+* Author: Shaun Bailey
+*
+* Date created: 16/10/2026
+*
+* Last Updated: 16/10/2026
+*
+*
+*
+* MIT License
+*
+* Copyright (c) 2021 Shaun Bailey
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*
+*/
+
+
+
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+#include "DxPRT/BVH.h"
+#include "DxPRT/BVH8.h"
+#include "DxPRT/GeneratePRT_CPU_Utility.h"
+#include "DxPRT/ObjReader.h"
+
+using namespace DxPRT_Utility;
+
+
+static const UINT64 NUM_RAYS = 1 << 20; // a multiple of RAYS_PER_VERTEX
+static const UINT64 RAYS_PER_VERTEX = 256; // rays sharing an origin, as traced for each vertex by GeneratePRT
+
+
+// traces every ray and returns the number traced per second, counting those that are occluded
+template <typename T>
+double TraceRays(const T& bvh, const std::vector<float>& origins, const std::vector<float>& directions,
+	UINT64& occludedNum)
+{
+	std::vector<UINT32> occluded(RAYS_PER_VERTEX);
+	occludedNum = 0;
+
+	auto startTime = std::chrono::steady_clock::now();
+	for (UINT64 iRay = 0; iRay < NUM_RAYS; iRay += RAYS_PER_VERTEX)
+	{
+		const float* x = &directions[iRay];
+		bvh.OccludedPacket(&origins[3 * (iRay / RAYS_PER_VERTEX)], x, x + NUM_RAYS, x + 2 * NUM_RAYS,
+			RAYS_PER_VERTEX, &occluded[0]);
+		for (UINT32 hit : occluded) occludedNum += hit;
+	}
+	double time = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+
+	return double(NUM_RAYS) / time;
+}
+
+
+int main(int argc, char** argv)
+{
+	std::string meshFile = argc > 1 ? argv[1] : "Bunny.obj";
+
+	ObjReader mesh;
+	if (!mesh.Load(meshFile)) {
+		std::cout << "Unable to read " << meshFile << std::endl;
+		return 1;
+	}
+	UINT64 vertexNum = mesh.GetSizeVertices() / 3;
+	UINT64 triangleNum = mesh.GetSizeIndices() / 3;
+	std::cout << meshFile << ": " << vertexNum << " vertices, " << triangleNum << " triangles" << std::endl;
+
+	BVH bvh(mesh.GetVertices(), vertexNum, mesh.GetIndices(), triangleNum);
+	BVH8 wideBVH(bvh);
+
+	// cosine weighted directions about the normals of random vertices, the x, y and z components
+	// are each stored contiguously
+	std::mt19937 generator(0);
+	std::uniform_real_distribution<float> uniform(0.0f, 1.0f);
+	std::uniform_int_distribution<UINT64> randomVertex(0, vertexNum - 1);
+	std::vector<float> origins(3 * (NUM_RAYS / RAYS_PER_VERTEX)), directions(3 * NUM_RAYS);
+	CPURayData rayData;
+	for (UINT64 iRay = 0; iRay < NUM_RAYS; ++iRay)
+	{
+		if (iRay % RAYS_PER_VERTEX == 0) {
+			UINT64 iVertex = randomVertex(generator);
+			InitializeCPURayData(rayData, &mesh.GetVertices()[3 * iVertex], &mesh.GetNormals()[3 * iVertex]);
+			for (int i = 0; i < 3; ++i) origins[3 * (iRay / RAYS_PER_VERTEX) + i] = rayData.rayPos[i];
+		}
+		float cosTheta = std::sqrt(1.0f - uniform(generator));
+		float sinTheta = std::sqrt(1.0f - cosTheta * cosTheta);
+		float phi = uniform(generator) * 6.2831853f;
+		for (int i = 0; i < 3; ++i) {
+			directions[i * NUM_RAYS + iRay] = sinTheta * std::cos(phi) * rayData.xDir[i] +
+				sinTheta * std::sin(phi) * rayData.yDir[i] + cosTheta * rayData.forward[i];
+		}
+	}
+
+	UINT64 binaryOccluded, wideOccluded;
+	double binaryRate = TraceRays(bvh, origins, directions, binaryOccluded);
+	double wideRate = TraceRays(wideBVH, origins, directions, wideOccluded);
+
+	std::cout << "Binary BVH: " << bvh.GetMemorySize() / 1024 << " KB, " << binaryRate / 1.0e6
+		<< " million rays/s (packets), " << binaryOccluded << " occluded" << std::endl;
+	std::cout << "8-wide BVH: " << wideBVH.GetMemorySize() / 1024 << " KB, " << wideRate / 1.0e6
+		<< " million rays/s, " << wideOccluded << " occluded" << std::endl;
+
+	return 0;
+}
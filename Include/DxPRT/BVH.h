@@ -0,0 +1,335 @@
+/*
+*
+* A bounding volume hierarchy (BVH) built over the vertex and index data of a mesh. This is used
+* to accelerate the visibility queries performed when generating the transfer functions on the
+* CPU (see GeneratePRT_CPU.h), reducing the cost of each ray from linear in the number of
+* triangles to roughly logarithmic.
+*
+* The hierarchy is built top-down using the surface area heuristic (SAH), where the triangle
+* centroids are sorted into a fixed number of bins along each axis to find the split with the
+* lowest expected cost. The nodes are stored in a single array, with the two children of an
+* interior node stored next to each other.
+*
+* The ray-triangle test used is the same as that in RayTracerShader.hlsl, such that the BVH gives
+* the same visibility as the compute shaders (see IntersectTriangle for the one difference).
+*
+*
+* This file is part of the implimentation and is not intended for public
+* use.
+*
+*
+* Forms part of the DxPRT project
+*
+*
+*
+* Author: Shaun Bailey
+*
+* Date created: 16/10/2026
+*
+* Last Updated: 16/10/2026
+*
+*
+*
+* MIT License
+*
+* Copyright (c) 2021 Shaun Bailey
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*
+*/
+
+#pragma once
+
+#include <vector>
+#include "DxPRT/Platform.h"
+
+
+namespace DxPRT_Utility {
+
+	/*
+	* A single node of the BVH. For an interior node, the children are stored at the indices
+	* leftFirst and leftFirst + 1 of the node array. For a leaf, the triangles are stored at
+	* [leftFirst, leftFirst + count) of the reordered triangle array.
+	*/
+	struct BVHNode
+	{
+		float boundsMin[3];
+		UINT32 leftFirst;
+		float boundsMax[3];
+		UINT32 count; // zero for interior nodes
+	};
+
+
+	// the settings used to build the BVH
+	struct BVHBuildSettings
+	{
+		UINT64 numThreads = 0; // the number of threads used, if 0 then every hardware thread is used
+		bool mortonPresort = false; // sort the triangles along a Morton curve and split the top of the tree by their codes
+	};
+
+
+	// describes the time taken to build the BVH and the quality of the tree
+	struct BVHBuildStats
+	{
+		double buildTime = 0.0; // in seconds
+		float sahCost = 0.0f; // expected cost of tracing a ray, relative to testing a single triangle
+		UINT32 maxDepth = 0;
+		double averageLeafDepth = 0.0;
+		UINT64 nodeNum = 0;
+		UINT64 leafNum = 0;
+		std::vector<UINT64> leafSizeHistogram; // element i is the number of leaves with i triangles
+	};
+
+
+	// the bounds of a single triangle, which are reordered as the nodes are split during the build
+	struct BVHPrimitive
+	{
+		float boundsMin[3];
+		UINT32 index; // index of the triangle in the mesh
+		float boundsMax[3];
+		UINT32 padding;
+	};
+
+
+	class ThreadPool;
+	struct BVHBinSet;
+
+	class BVH
+	{
+	public:
+
+		// default constructor
+		BVH();
+
+		// constructor that automatically calls the Build function
+		BVH(const float* vertexData, const UINT64& vertexNum,
+			const UINT32* indexData, const UINT64& triangleNum,
+			const BVHBuildSettings& settings = BVHBuildSettings());
+
+		/*
+		* Build: builds the hierarchy over the triangles of a mesh. The triangles are copied
+		* such that the pointers do not need to remain valid after this call. The top of the
+		* tree is split first, with the binning of each large node shared between the threads,
+		* after which the remaining subtrees are built as independent tasks. The tree does not
+		* depend on the number of threads. If settings.mortonPresort is set, then the top of
+		* the tree is instead split by the Morton codes of the triangles, which is faster but
+		* gives a slightly worse tree.
+		*
+		* _IN_ vertexData: pointer to the vertex data, this should contain 3 floats per vertex
+		* _IN_ vertexNum: the total number of vertices in the mesh
+		* _IN_ indexData: pointer to the index data, this should contain 3 unsigned integers per triangle
+		* _IN_ triangleNum: the total number of triangles in the mesh
+		* _IN_ settings: the number of threads and whether the Morton codes are used
+		*/
+		void Build(const float* vertexData, const UINT64& vertexNum,
+			const UINT32* indexData, const UINT64& triangleNum,
+			const BVHBuildSettings& settings = BVHBuildSettings());
+
+		/*
+		* Occluded: any-hit query, returns true if the ray hits any triangle. The traversal
+		* stops as soon as a hit is found.
+		*
+		* _IN_ origin: the origin of the ray (3 floats)
+		* _IN_ direction: the direction of the ray (3 floats)
+		*/
+		bool Occluded(const float* origin, const float* direction) const;
+
+		/*
+		* OccludedPacket: any-hit query for a stream of rays that share the same origin, such as
+		* the hemisphere of rays about a vertex. The rays are traced in packets of SIMD_WIDTH (see
+		* SIMD.h), with each node first culled against a frustum bounding the whole packet and then
+		* tested against every ray in the packet at once. The edge vectors of each triangle are
+		* calculated once per packet rather than once per ray. Neighbouring rays should have
+		* similar directions for the culling to be effective, so the CPU backend generates every
+		* direction of a vertex and sorts them into cells of similar direction before tracing
+		*
+		* _IN_ origin: the origin shared by all of the rays (3 floats)
+		* _IN_ directionX: the x component of the direction of each ray
+		* _IN_ directionY: the y component of the direction of each ray
+		* _IN_ directionZ: the z component of the direction of each ray
+		* _IN_ rayNum: the number of rays
+		* _OUT_ occluded: set to 1 for each ray that hits a triangle, and 0 otherwise
+		*/
+		void OccludedPacket(const float* origin, const float* directionX, const float* directionY,
+			const float* directionZ, const UINT64& rayNum, UINT32* occluded) const;
+
+		/*
+		* HasOccluders: hemisphere query, returns true if any triangle could be hit by a ray leaving
+		* the origin above the plane with the given normal (see CanOcclude). If this returns false,
+		* then Occluded is false for every direction with a positive component along the normal,
+		* and the CPU backend gives the vertex the closed form transfer (see CalcCosineZonal)
+		* without tracing any rays. Nodes whose boxes lie entirely on or below the plane are skipped
+		*
+		* _IN_ origin: the origin of the hemisphere (3 floats)
+		* _IN_ normal: the normal of the plane (3 floats), this does not need to be normalized
+		*/
+		bool HasOccluders(const float* origin, const float* normal) const;
+
+		// returns true once the hierarchy has been built
+		bool IsBuilt() const;
+
+		// returns the time taken by the last build and the quality of the tree
+		const BVHBuildStats& GetBuildStats() const;
+
+		// returns a pointer to the nodes, the root is the first node
+		const BVHNode* GetNodes() const;
+
+		// returns the number of nodes
+		size_t GetNodeCount() const;
+
+		// returns a pointer to the triangles in the order referenced by the leaves, each
+		// triangle is stored as 9 floats (the 3 vertices)
+		const float* GetTriangles() const;
+
+		// returns the index in the original index data of each reordered triangle
+		const UINT32* GetTriangleIndices() const;
+
+		// returns the number of triangles
+		size_t GetTriangleCount() const;
+
+		// returns the number of bytes used by the nodes, triangles and triangle indices
+		size_t GetMemorySize() const;
+
+		/*
+		* IntersectTriangle: the ray-triangle test of RayTracerShader.hlsl. The ray hits if it
+		* passes through the same (negative) side of each edge of the triangle as seen from the
+		* origin, and the triangle lies in front of the origin. Unlike the shader, the latter is
+		* found from the sign of the triple product of the vertices, such that triangles behind
+		* the origin are never counted as a hit
+		*
+		* _IN_ triangle: the 9 floats of the triangle vertices
+		* _IN_ origin: the origin of the ray
+		* _IN_ direction: the direction of the ray
+		*/
+		static bool IntersectTriangle(const float* triangle, const float* origin,
+			const float* direction);
+
+		/*
+		* CanOcclude: returns true if IntersectTriangle could be true for a ray leaving the origin
+		* above the plane with the given normal. The triangle must face the origin (the triple product
+		* of its vertices is negative), must not have a vertex at the origin and must have a vertex
+		* above the plane
+		*
+		* _IN_ triangle: the 9 floats of the triangle vertices
+		* _IN_ origin: the origin of the rays
+		* _IN_ normal: the normal of the plane
+		*/
+		static bool CanOcclude(const float* triangle, const float* origin, const float* normal);
+
+	private:
+
+		/*
+		* Subdivide: splits a node into two children using the binned SAH. Returns false if
+		* the node is kept as a leaf.
+		*
+		* _IN/OUT_ nodes: the nodes of the tree, or of a subtree, the children are appended
+		* _IN_ iNode: index of the node to be split
+		* _IN_ depth: the depth of the node in the hierarchy
+		* _IN_ threadPool: if not nullptr, then the binning of large nodes is shared between its threads
+		*/
+		bool Subdivide(std::vector<BVHNode>& nodes, const UINT32& iNode, const UINT32& depth,
+			ThreadPool* threadPool);
+
+		/*
+		* SubdivideMorton: splits a node at the highest bit that differs between the Morton codes
+		* of its triangles. Returns false if every code is the same
+		*
+		* _IN/OUT_ nodes: the nodes of the tree, the children are appended
+		* _IN_ iNode: index of the node to be split
+		* _IN_ mortonCodes: the sorted code of each triangle (see SortMorton)
+		* _IN_ threadPool: used to find the bounds of the children
+		*/
+		bool SubdivideMorton(std::vector<BVHNode>& nodes, const UINT32& iNode,
+			const std::vector<UINT32>& mortonCodes, ThreadPool* threadPool);
+
+		/*
+		* SortMorton: sorts the primitives by the Morton codes of their centroids
+		*
+		* _OUT_ mortonCodes: the code of each sorted triangle
+		* _IN_ threadPool: the threads used
+		*/
+		void SortMorton(std::vector<UINT32>& mortonCodes, ThreadPool* threadPool);
+
+		/*
+		* BinPrimitives: adds a range of primitives to the bins of each axis
+		*
+		* _IN_ first: position of the first primitive in primitives_
+		* _IN_ end: one past the position of the last primitive
+		* _IN_ centroidMin: the lower bounds of the centroids of the node
+		* _IN_ scale: the number of bins per unit length along each axis, 0 if the axis is not binned
+		* _IN/OUT_ binSet: the bins
+		*/
+		void BinPrimitives(const UINT32& first, const UINT32& end, const float* centroidMin,
+			const float* scale, BVHBinSet& binSet) const;
+
+		/*
+		* CentroidBounds: calculates the bounding box of the centroids of the primitives of a node
+		*
+		* _IN_ node: the node
+		* _OUT_ centroidMin: the lower bounds (3 floats)
+		* _OUT_ centroidMax: the upper bounds (3 floats)
+		* _IN_ threadPool: the threads used for large nodes, may be nullptr
+		*/
+		void CentroidBounds(const BVHNode& node, float* centroidMin, float* centroidMax,
+			ThreadPool* threadPool) const;
+
+		/*
+		* UpdateBounds: calculates the bounding box of a node from its primitives
+		*
+		* _IN/OUT_ node: the node
+		* _IN_ threadPool: the threads used for large nodes, may be nullptr
+		*/
+		void UpdateBounds(BVHNode& node, ThreadPool* threadPool) const;
+
+		// fills in buildStats_ from the finished tree
+		void CalcBuildStats();
+
+		/*
+		* IntersectNode: slab test between a ray and the bounding box of a node. Returns the
+		* distance to the box, or infinity if the box is missed
+		*
+		* _IN_ node: the node to be tested
+		* _IN_ origin: the origin of the ray
+		* _IN_ invDirection: the reciprocal of each component of the ray direction
+		*/
+		static float IntersectNode(const BVHNode& node, const float* origin,
+			const float* invDirection);
+
+		/*
+		* TracePacket: traces a single packet of SIMD_WIDTH rays (see OccludedPacket), returning
+		* a mask with the bit set for each ray that hits a triangle
+		*
+		* _IN_ origin: the origin shared by all of the rays
+		* _IN_ directions: the x, y and z components of the ray directions, SIMD_WIDTH floats each
+		* _IN_ activeMask: mask of the rays within the packet that are to be traced
+		*/
+		UINT32 TracePacket(const float* origin, const float* const* directions,
+			const UINT32& activeMask) const;
+
+		std::vector<BVHNode> nodes_;
+		std::vector<BVHPrimitive> primitives_; // only used during the build
+		std::vector<UINT32> triangleIndices_;
+		std::vector<float> triangles_; // 9 floats per triangle, reordered once built
+
+		BVHBuildStats buildStats_;
+		bool isBuilt_ = false;
+
+	};
+
+}
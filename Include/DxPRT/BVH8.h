@@ -0,0 +1,183 @@
+/*
+*
+* An 8-wide bounding volume hierarchy, built by collapsing the binary BVH (see BVH.h). This is used
+* for the visibility queries of the CPU implementation when the binary hierarchy and its triangles
+* no longer fit in the cache, such that the traversal is limited by memory bandwidth.
+*
+* Each node stores the boxes of up to 8 children, quantized to 8 bits along each axis relative to
+* the box of the node. The quantized boxes always contain the original boxes, so the hierarchy gives
+* the same visibility as the binary BVH. The boxes of all 8 children are tested against a ray at
+* once using SIMDFloat8 (see SIMD.h). The triangles are stored in blocks of 8, with each vertex
+* component stored contiguously, such that 8 triangles are also tested at once. The triangles of the
+* leaves are packed one after another, so a leaf may start part of the way through a block.
+*
+* Unlike the binary BVH, rays are always traced one at a time, as the SIMD lanes are used by the
+* children of each node rather than by a packet of rays.
+*
+*
+* This file is part of the implimentation and is not intended for public
+* use.
+*
+*
+* Forms part of the DxPRT project
+*
+*
+*
+* Author: Shaun Bailey
+*
+* Date created: 16/10/2026
+*
+* Last Updated: 16/10/2026
+*
+*
+*
+* MIT License
+*
+* Copyright (c) 2021 Shaun Bailey
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*
+*/
+
+#pragma once
+
+#include <vector>
+#include "DxPRT/Platform.h"
+
+
+namespace DxPRT_Utility {
+
+	class BVH;
+
+	static const UINT32 BVH8_WIDTH = 8; // the number of children of a node and triangles of a block
+
+	/*
+	* A single node of the 8-wide BVH. The box of child i along axis k is given by
+	* origin[k] + scale[k] * boundsMin[k][i] and origin[k] + scale[k] * boundsMax[k][i], where the
+	* scale is a power of two. Only the first childNum children are used. If bit i of leafMask
+	* is set, then child i is a leaf of leafSize[i] triangles, starting from triangle child[i] of
+	* the blocks. Otherwise child[i] is the index of another node.
+	*/
+	struct BVH8Node
+	{
+		float origin[3];
+		float scale[3];
+		UINT8 boundsMin[3][BVH8_WIDTH];
+		UINT8 boundsMax[3][BVH8_WIDTH];
+		UINT32 child[BVH8_WIDTH];
+		UINT8 leafSize[BVH8_WIDTH];
+		UINT8 childNum;
+		UINT8 leafMask;
+		UINT8 padding[6];
+	};
+
+
+	// 8 triangles, stored such that vertices[3 * j + k][i] is component k of vertex j of triangle i
+	struct BVH8TriangleBlock
+	{
+		float vertices[9][BVH8_WIDTH];
+	};
+
+
+	class BVH8
+	{
+	public:
+
+		BVH8();
+
+		// constructor that automatically calls the Build function
+		BVH8(const BVH& bvh);
+
+		/*
+		* Build: collapses a binary BVH into an 8-wide BVH. Starting from the two children of a
+		* binary node, the child with the largest surface area is repeatedly replaced by its own
+		* children until there are 8. Any subtree with at most 8 triangles becomes a single leaf,
+		* while leaves with more than 255 triangles are split in half. The triangles are copied,
+		* such that the binary BVH can be destroyed after this call.
+		*
+		* _IN_ bvh: the binary BVH, this must be built
+		*/
+		void Build(const BVH& bvh);
+
+		/*
+		* Occluded: any-hit query, returns true if the ray hits any triangle. Gives the same
+		* result as BVH::Occluded
+		*
+		* _IN_ origin: the origin of the ray
+		* _IN_ direction: the direction of the ray, this does not need to be normalized
+		*/
+		bool Occluded(const float* origin, const float* direction) const;
+
+		/*
+		* OccludedPacket: any-hit query for a stream of rays that share the same origin, with the
+		* same arguments as BVH::OccludedPacket. The rays are traced one at a time
+		*
+		* _IN_ origin: the shared origin of the rays
+		* _IN_ directionX: the x components of the directions of the rays
+		* _IN_ directionY: the y components of the directions of the rays
+		* _IN_ directionZ: the z components of the directions of the rays
+		* _IN_ rayNum: the number of rays
+		* _OUT_ occluded: set to 1 for each ray that hits a triangle, 0 otherwise
+		*/
+		void OccludedPacket(const float* origin, const float* directionX, const float* directionY,
+			const float* directionZ, const UINT64& rayNum, UINT32* occluded) const;
+
+		/*
+		* HasOccluders: hemisphere query, gives the same result as BVH::HasOccluders
+		*
+		* _IN_ origin: the origin of the hemisphere
+		* _IN_ normal: the normal of the plane, this does not need to be normalized
+		*/
+		bool HasOccluders(const float* origin, const float* normal) const;
+
+		// returns true once the hierarchy has been built
+		bool IsBuilt() const;
+
+		// returns the number of nodes
+		size_t GetNodeCount() const;
+
+		// returns the number of triangle blocks
+		size_t GetBlockCount() const;
+
+		// returns the number of bytes used by the nodes and triangles
+		size_t GetMemorySize() const;
+
+	private:
+
+		/*
+		* IntersectLeaf: tests a ray against the triangles of a leaf, the same test as
+		* BVH::IntersectTriangle applied to the 8 triangles of a block at once
+		*
+		* _IN_ first: the first triangle of the leaf
+		* _IN_ count: the number of triangles
+		* _IN_ origin: the origin of the ray
+		* _IN_ direction: the direction of the ray
+		*/
+		bool IntersectLeaf(const UINT32& first, const UINT32& count, const float* origin,
+			const float* direction) const;
+
+		std::vector<BVH8Node> nodes_;
+		std::vector<BVH8TriangleBlock> blocks_;
+		UINT64 triangleNum_ = 0;
+
+		bool isBuilt_ = false;
+
+	};
+
+}
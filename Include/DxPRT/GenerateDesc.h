@@ -0,0 +1,129 @@
+/*
+*
+* This file contains the EM_DESC and PRT_DESC structs used to define the operation of the
+* GenerateEM and GeneratePRT functions (see GeneratePRT.h and GeneratePRT_CPU.h). These are
+* kept separate from the DirectX12 headers so that the CPU implementation can be used on
+* machines without a GPU.
+*
+* Each member of these objects has a default value so it is not nessecary to define each element
+* unless a different value is required.
+*
+*
+* Forms part of the DxPRT project
+*
+*
+*
+* Author: Shaun Bailey
+*
+* Date created: 16/10/2026
+*
+* Last Updated: 16/10/2026
+*
+*
+*
+* MIT License
+*
+* Copyright (c) 2021 Shaun Bailey
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*
+*/
+
+#pragma once
+#include <memory>
+#include <string>
+#include "DxPRT/Platform.h"
+
+namespace DxPRT_Utility {
+	class SHTable;
+}
+
+namespace DxPRT {
+
+	// selects where the ray tracing and integration in GenerateEM and GeneratePRT is performed
+	enum PRT_BACKEND {
+		PRT_BACKEND_GPU = 0, // compute shaders executed on the device passed to GenerateEM or GeneratePRT
+		PRT_BACKEND_CPU = 1 // multi-threaded implementation on the CPU, no device is required
+	};
+
+
+	// selects how the random numbers of each Monte Carlo event are generated. The quasi-Monte Carlo
+	// modes converge faster than pseudo-random numbers, and so fewer events are needed for the same
+	// error. These are only supported by the CPU backend
+	enum SAMPLING_MODE {
+		SAMPLING_PSEUDO_RANDOM = 0, // the pseudo-random number generator of the shaders
+		SAMPLING_SOBOL = 1, // Owen scrambled Sobol sequence, best with a power of two number of events
+		SAMPLING_LATTICE = 2 // rank-1 lattice with a random shift (Cranley-Patterson rotation)
+	};
+
+
+	// selects how the CPU backend of GeneratePRT finds the directions about a vertex that are blocked by the mesh
+	enum VISIBILITY_MODE {
+		VISIBILITY_RAY_TRACING = 0, // a ray is traced through the BVH for each event
+		VISIBILITY_HEMICUBE = 1 // the mesh is rasterized once per vertex into a hemicube of binary pixels, which each event looks up
+	};
+
+
+	// selects the format of the .prt files written by GenerateEM and GeneratePRT, both are read by the Workspace
+	enum PRT_FILE_FORMAT {
+		PRT_FILE_FORMAT_TEXT = 0, // human readable lines of text
+		PRT_FILE_FORMAT_BINARY = 1 // versioned binary file that is mapped into memory when read, see PRTBinary.h
+	};
+
+
+	// the EM_DESC object used to define the integration over the environment map in GenerateEM
+	struct EM_DESC {
+		UINT64 MaxL = 3; // maximum l value for the spherical harmonics
+		UINT64 NumEvents = 262144; // total number of events used in the Monte Carlo Integration
+		UINT64 SHGridNum = 512; // the number of grid points (in both theta and phi) used to store the spherical harmonics
+		bool SuppressOutput = false; // if set to true, no text will be output to the console
+		std::wstring shaderPath = L""; // path to the folder containing the shader files
+		PRT_BACKEND Backend = PRT_BACKEND_GPU; // where the integration is performed
+		UINT64 NumThreads = 0; // number of threads used by the CPU backend, 0 uses every hardware thread
+		SAMPLING_MODE Sampling = SAMPLING_PSEUDO_RANDOM; // how the random numbers are generated
+		UINT64 Seed = 0; // seed of the random numbers, the same seed and settings give the same result
+		PRT_FILE_FORMAT OutputFormat = PRT_FILE_FORMAT_TEXT; // format of the output file
+		std::shared_ptr<const DxPRT_Utility::SHTable> SHGridTable = nullptr; // grids reused by the GPU backend, see SHTable.h
+	};
+
+
+	// the EM_DESC object used to define the integration over the transfer funtions in GeneratePRT
+	struct PRT_DESC {
+		UINT64 MaxL = 3; // maximum l value for the spherical harmonics
+		UINT64 NumEvents = 262144; // total number of events used in the Monte Carlo Integration
+		UINT64 SHGridNum = 512; // the number of grid points (in both theta and phi) used to store the spherical harmonics
+		bool SuppressOutput = false; // if set to true, no text will be output to the console
+		std::wstring shaderPath = L""; // path to the folder containing the shader files
+		PRT_BACKEND Backend = PRT_BACKEND_GPU; // where the ray tracing and integration is performed
+		UINT64 NumThreads = 0; // number of threads used by the CPU backend, 0 uses every hardware thread
+		bool PacketTraversal = true; // if set to true, the CPU backend traces the rays of each vertex in SIMD packets
+		bool WideBVH = false; // if set to true, the CPU backend traces rays through a compressed 8-wide BVH, using less memory
+		bool MortonBVH = false; // if set to true, the top of the CPU backend's BVH is split by Morton codes, building faster but tracing slightly slower
+		bool AnalyticUnoccluded = true; // if set to true, the CPU backend uses the closed form transfer for vertices with nothing above their tangent plane, rather than tracing rays
+		bool ControlVariate = false; // if set to true, the CPU backend only samples the occluded part of the transfer, which is subtracted from the closed form unshadowed transfer
+		VISIBILITY_MODE Visibility = VISIBILITY_RAY_TRACING; // how the CPU backend finds the occluded events
+		UINT64 HemicubeResolution = 128; // the pixels along each edge of a hemicube face, rounded up to a multiple of 16
+		SAMPLING_MODE Sampling = SAMPLING_PSEUDO_RANDOM; // how the random numbers are generated
+		UINT64 Seed = 0; // seed of the random numbers, the same seed and settings give the same result
+		PRT_FILE_FORMAT OutputFormat = PRT_FILE_FORMAT_TEXT; // format of the output file
+		bool ResumeOutput = false; // if set to true, a binary output file left unfinished by an earlier call with the same mesh and settings is completed rather than started again
+		std::shared_ptr<const DxPRT_Utility::SHTable> SHGridTable = nullptr; // grids reused by the GPU backend, see SHTable.h
+	};
+
+}
@@ -0,0 +1,110 @@
+/*
+*
+* Functions used in the implimentation of GenerateEM on the CPU (see GeneratePRT_CPU.h). The
+* integration follows EMIntegrateShader.hlsl, with the environment map and spherical harmonic
+* grids sampled bilinearly in the same way as the textures used by the shader.
+*
+*
+* This file is part of the implimentation and is not intended for public
+* use.
+*
+*
+* Forms part of the DxPRT project
+*
+*
+*
+* Author: Shaun Bailey
+*
+* Date created: 16/10/2026
+*
+* Last Updated: 16/10/2026
+*
+*
+*
+* MIT License
+*
+* Copyright (c) 2021 Shaun Bailey
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*
+*/
+
+#pragma once
+#include <vector>
+#include "DxPRT/Platform.h"
+#include "DxPRT/GenerateDesc.h"
+#include "DxPRT/GenerateGeneral_Utility.h"
+
+namespace DxPRT_Utility {
+
+    // contains the constants used in the generation of the EM coefficients on the CPU
+    struct EMCPUConstantContainer {
+        UINT64 numPixelsX;
+        UINT64 numPixelsY;
+        UINT64 numEvents;
+        UINT64 shGridNum;
+        UINT64 maxL;
+        UINT64 nCoefficients;
+        UINT64 numThreads;
+        DxPRT::SAMPLING_MODE sampling;
+        UINT64 latticeGenerator; // see LatticeGenerator
+        UINT64 seed;
+    };
+
+
+    /*
+    * InitializeEMCPUConstants: initializes the constants used in the CPU implementation of GenerateEM.
+    * The number of events and grid points are rounded in the same way as on the GPU
+    *
+    * _IN_ desc: the EM_DESC object passed on initialization
+    * _IN_ numPixelsX: width of the hdr image
+    * _IN_ numPixelsY: height of the hdr image
+    */
+    EMCPUConstantContainer InitializeEMCPUConstants(const DxPRT::EM_DESC& desc, const UINT64& numPixelsX,
+        const UINT64& numPixelsY);
+
+
+    /*
+    * SampleEnvironmentMap: bilinearly samples the environment map with clamped texture coordinates,
+    * equivalent to the linear clamp sampler used by the shader
+    *
+    * _OUT_ colour: the 3 floats of the sampled colour
+    * _IN_ data: the environment map, 3 floats per pixel with rows along the x-direction
+    * _IN_ constants: contains the size of the environment map
+    * _IN_ u: the texture coordinate along the x-direction, in [0, 1]
+    * _IN_ v: the texture coordinate along the y-direction, in [0, 1]
+    */
+    void SampleEnvironmentMap(float* colour, const float* data, const EMCPUConstantContainer& constants,
+        const float& u, const float& v);
+
+
+    /*
+    * IntegrateEM: calculates the spherical harmonic coefficients of the environment map. The events are
+    * split into fixed ranges between the threads of a ThreadPool, each of which sums the product of the
+    * spherical harmonics and the environment map over its ranges. The spherical harmonics are evaluated
+    * directly for blocks of events (see CalcSHDirections), rather than sampled from grids
+    *
+    * _OUT_ coefficients: the 3 coefficients (red, green and blue) of each spherical harmonic are appended
+    * _IN_ data: the environment map
+    * _IN_ constants: the parameters needed to describe the integration
+    */
+    void IntegrateEM(std::vector<float>& coefficients, const float* data,
+        const EMCPUConstantContainer& constants);
+
+}
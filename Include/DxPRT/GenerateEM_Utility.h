@@ -55,6 +55,7 @@
 #include "DxPRT/CommandList.h"
 #include "DxPRT/CommandQueue.h"
 #include "DxPRT/SphericalHarmonics.h"
+#include "DxPRT/SHTable.h"
 #include "DxPRT/Resource.h"
 #include "DxPRT/DescriptorHeap.h"
 #include "DxPRT/PRTWriter.h"
@@ -98,6 +99,7 @@ namespace DxPRT_Utility {
         UINT64 numThreadGroups;
         UINT64 maxL;
         UINT64 nCoefficients;
+        UINT64 seed;
     };
 
     /*
@@ -123,12 +125,12 @@ namespace DxPRT_Utility {
     * _OUT_ resources: a container for all the resources to be used
     * _IN_ constants: a container for all the constants used
     * _IN_ data: a poiner to the hdr data
-    * _IN_ shData: grids containing the spherical harmonics
+    * _IN_ shTable: grids containing the spherical harmonics
     * _IN_ randomVector: a vector containing random integers
     */
     void InitializeEMResources(ID3D12Device* device, CommandQueue& commandQueue, CommandList& commandList,
         EMResourceContainer& resources, const EMConstantContainer& constants,
-        const void* data, const std::vector<std::vector<float>>& shData,
+        const void* data, const SHTable& shTable,
         const std::vector<UINT32>& randomVector);
 
     /*
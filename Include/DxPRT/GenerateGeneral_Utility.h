@@ -49,30 +49,28 @@
 #pragma once
 
 #include <vector>
-#include <d3d12.h>
+#include "DxPRT/Platform.h"
+#include "DxPRT/GenerateDesc.h"
 #include "DxPRT/SphericalHarmonics.h"
 
 namespace DxPRT_Utility {
 
+	// the number of vertices whose coefficients are held in memory by a thread before being written
+	// to a binary .prt file (see PRTStreamWriter in PRTWriter.h)
+	static const UINT64 PRT_STREAM_VERTEX_NUM = 256;
 
-	/*
-	* GenerateSHVector: generates grids of spherical harmonics
-	* 
-	* _IN_ shGridNum: the number of grid points in both the theta and phi directions
-	* _IN_ maxL: the maximum value of l for the generated spherical harmonics
-	* _OUT_shVector: a vector containing grids of sphierical hamonics for each l and m value (the grid is
-	*                also stored as a vector)
-	*/
-	void GenerateSHvector(const UINT64& shGridNum, const UINT64& maxL, std::vector<std::vector<float>>& shVector);
 
 	/*
-	* GenerateRandomVector: generates a vector of random integers between 128 and 2^32, used for the 
-	* generation of random numbers on the GPU
+	* GenerateRandomVector: generates a vector of random integers between 128 and 2^32, used to seed the
+	* generation of random numbers on the GPU. The integers are found from the counter-based generator
+	* in Sampling.h, such that the same seed always gives the same vector
 	* 
 	* _IN_ numEvents: the number of Monte Carlo Events that will need random numbers
 	* _OUT_ randomVector: the vector containing the random numbers
+	* _IN_ seed: the seed of the random numbers
 	*/
-	void GenerateRandomVector(const UINT64& numEvents, std::vector<UINT32>& randomVector);
+	void GenerateRandomVector(const UINT64& numEvents, std::vector<UINT32>& randomVector,
+		const UINT64& seed);
 
 
 	/*
@@ -91,6 +89,18 @@ namespace DxPRT_Utility {
 		UINT64& roundedNumEventsX, UINT64& roundedSHGridNum);
 
 
+	/*
+	* PRTSettingsKey: returns a hash of the normals and of each setting of desc that changes the
+	* coefficients, stored by PRTStreamWriter such that an interrupted bake is only resumed with the
+	* same settings
+	*
+	* _IN_ desc: the settings of the bake
+	* _IN_ pNormal: the normal of each vertex
+	* _IN_ vertexNum: the number of vertices
+	*/
+	UINT64 PRTSettingsKey(const DxPRT::PRT_DESC& desc, const float* pNormal, const UINT64& vertexNum);
+
+
 }
 
 
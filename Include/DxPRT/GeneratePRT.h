@@ -16,6 +16,10 @@
 * provided if nessecary. It should be noted that the ray tracer may be rather slow for large meshes (>10000 vertices),
 * however work is under way to improve this
 * 
+* The transfer functions may also be calculated on the CPU by setting the Backend member of PRT_DESC to
+* PRT_BACKEND_CPU. In this case no device is required and the functions in GeneratePRT_CPU.h may be called
+* directly, allowing for the coefficients to be generated on machines without a GPU.
+* 
 * To set the settings of the integration performed, EM_DESC and PRT_DESC objects need to be defined. Each member of these
 * objects has a default value so it is not nessecary to define each element unless a different value is defined. Please
 * see the definitions below for each element. However, note that some values (paricularly the number of Monte Carlo events)
@@ -72,32 +76,16 @@
 #include "DxPRT/DescriptorHeap.h"
 #include "DxPRT/PRTWriter.h"
 #include "DxPRT/ObjReader.h"
+#include "DxPRT/PlyReader.h"
 #include "DxPRT/HDRReader.h"
 #include "DxPRT/GenerateEM_Utility.h"
 #include "DxPRT/GeneratePRT_Utility.h"
 #include "DxPRT/GenerateGeneral_Utility.h"
+#include "DxPRT/GenerateDesc.h"
+#include "DxPRT/GeneratePRT_CPU.h"
 
 namespace DxPRT {
 
-	// the EM_DESC object used to define the integration over the environment map in GenerateEM
-	struct EM_DESC {
-		UINT64 MaxL = 3; // maximum l value for the spherical harmonics
-		UINT64 NumEvents = 262144; // total number of events used in the Monte Carlo Integration
-		UINT64 SHGridNum = 512; // the number of grid points (in both theta and phi) used to store the spherical harmonics
-		bool SuppressOutput = false; // if set to true, no text will be output to the console
-		std::wstring shaderPath = L""; // path to the folder containing the shader files
-	};
-
-
-	// the EM_DESC object used to define the integration over the transfer funtions in GeneratePRT
-	struct PRT_DESC {
-		UINT64 MaxL = 3; // maximum l value for the spherical harmonics
-		UINT64 NumEvents = 262144; // total number of events used in the Monte Carlo Integration
-		UINT64 SHGridNum = 512; // the number of grid points (in both theta and phi) used to store the spherical harmonics
-		bool SuppressOutput = false; // if set to true, no text will be output to the console
-		std::wstring shaderPath = L""; // path to the folder containing the shader files
-	};
-
 	/*
 	* GenerateEM: processes and environment map to generate a .prt file containing the 
 	* spherical harmonic coefficients. The data file must have phi vary along the 
@@ -141,7 +129,8 @@ namespace DxPRT {
 	* _IN_ triangleNum: the total number of triangles in the mesh
 	* _IN_ normalData: a pointer to the normal data, this should contain 3 floats per normal
 	* _IN_ outFile: the path to the output file where the coefficients for each vertex will be stored
-	* _IN_ desc: an PRT_DESC object containing parameters for the ray tracer and integration
+	* _IN_ desc: an PRT_DESC object containing parameters for the ray tracer and integration. If 
+	*           desc.Backend is PRT_BACKEND_CPU then the CPU implementation is used and device may be nullptr
 	*/
 	void GeneratePRT(ID3D12Device* device, void* vertexData,
 		const UINT64& vertexNum, void* indexData, const UINT64& triangleNum,
@@ -150,16 +139,17 @@ namespace DxPRT {
 
 
 	/*
-	* GeneratePRT: same functionallity as the above function but takes in a .obj file as input
+	* GeneratePRT: same functionallity as the above function but takes in a .obj file, or a binary
+	* little-endian .ply file (chosen by the .ply extension), as input
 	* 
 	* 
 	* _IN_ device: the currently active device
-	* _IN_ objFile: the path to the object file to be read
+	* _IN_ meshFile: the path to the .obj or .ply file to be read
 	* _IN_ outFile: the path to the output file where the coefficients for each vertex will be stored
 	* _IN_ desc: an PRT_DESC object containing parameters for the ray tracer and integration
 	
 	*/
-	void GeneratePRT(ID3D12Device* device, const std::string& objFile,
+	void GeneratePRT(ID3D12Device* device, const std::string& meshFile,
 		const std::string& outFile, const PRT_DESC& desc);
 
 }
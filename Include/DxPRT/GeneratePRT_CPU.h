@@ -0,0 +1,113 @@
+/*
+*
+* This file contains the CPU implementation of the GeneratePRT function (see GeneratePRT.h). The
+* same ray tracing and integration performed by the compute shaders is instead spread over the
+* threads of the CPU. As no device is required, the functions in this file may be used on machines
+* without a GPU, including those that are not running Windows. The resulting .prt files are written
+* in the same format and can be read in by the Workspace class as usual.
+*
+*
+* Forms part of the DxPRT project
+*
+*
+*
+* Author: Shaun Bailey
+*
+* Date created: 16/10/2026
+*
+* Last Updated: 16/10/2026
+*
+*
+*
+* MIT License
+*
+* Copyright (c) 2021 Shaun Bailey
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*
+*/
+
+#pragma once
+#include <string>
+#include "DxPRT/Platform.h"
+#include "DxPRT/GenerateDesc.h"
+
+namespace DxPRT {
+
+	/*
+	* GenerateEM: processes an environment map to generate a .prt file containing the spherical
+	* harmonic coefficients on the CPU. The integration matches that of the compute shader used when
+	* a device is provided, with the events split over desc.NumThreads threads. The Backend member of
+	* desc is ignored. The data file must have phi vary along the x-direction and theta vary along the
+	* y-direction. If the output file cannot be accessed, then this function will fail.
+	*
+	* _IN_ data: a pointer to the environment map, this should contain 3 floats per pixel
+	* _IN_ numPixelsX: the number of pixels in the x-direction (width)
+	* _IN_ numPixelsY: the number of pixels in the y-direction (height)
+	* _IN_ outFile: the path to the output file where the coefficients will be stored
+	* _IN_ desc: an EM_DESC object containing parameters for the integration
+	*/
+	void GenerateEM(void* data, const UINT64& numPixelsX, const UINT64& numPixelsY,
+		const std::string& outFile, const EM_DESC& desc);
+
+
+	/*
+	* GenerateEM: same functionallity as the above function but takes in a .hdr file as input. This
+	* file must be in the RGBE format and be run-length encoded.
+	*
+	* _IN_ hdrFile: the path to the hdr file to be read
+	* _IN_ outFile: the path to the output file where the coefficients will be stored
+	* _IN_ desc: an EM_DESC object containing parameters for the integration
+	*/
+	void GenerateEM(const std::string& hdrFile, const std::string& outFile, const EM_DESC& desc);
+
+
+	/*
+	* GeneratePRT: processes a mesh to generate the spherical harmoic coefficients to describe
+	* the transfer function on the CPU. The ray tracing and integration matches that of the 
+	* compute shaders used when a device is provided, and the vertices are split over
+	* desc.NumThreads threads. The Backend member of desc is ignored. If the output file
+	* cannot be accessed, then this function will fail.
+	* 
+	* _IN_ vertexData: a pointer to the vertex data, this should contain 3 floats per vertex
+	* _IN_ vertexNum: the total number of vertices in the mesh
+	* _IN_ indexData: a pointer to the index data, this should contain 3 4-byte unsigned integers per triangle
+	* _IN_ triangleNum: the total number of triangles in the mesh
+	* _IN_ normalData: a pointer to the normal data, this should contain 3 floats per normal
+	* _IN_ outFile: the path to the output file where the coefficients for each vertex will be stored
+	* _IN_ desc: an PRT_DESC object containing parameters for the ray tracer and integration
+	*/
+	void GeneratePRT(void* vertexData, const UINT64& vertexNum, void* indexData,
+		const UINT64& triangleNum, void* normalData, const std::string& outFile,
+		const PRT_DESC& desc);
+
+
+	/*
+	* GeneratePRT: same functionallity as the above function but takes in a .obj file, or a binary
+	* little-endian .ply file (chosen by the .ply extension), as input
+	* 
+	* 
+	* _IN_ meshFile: the path to the .obj or .ply file to be read
+	* _IN_ outFile: the path to the output file where the coefficients for each vertex will be stored
+	* _IN_ desc: an PRT_DESC object containing parameters for the ray tracer and integration
+	*/
+	void GeneratePRT(const std::string& meshFile, const std::string& outFile,
+		const PRT_DESC& desc);
+
+}
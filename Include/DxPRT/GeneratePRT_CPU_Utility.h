@@ -0,0 +1,209 @@
+/*
+*
+* This file contains functions and structs used by the CPU implementation of GeneratePRT
+* (see GeneratePRT_CPU.h). These mirror the compute shaders RayTracerShader.hlsl and
+* PRTIntegrateShader.hlsl such that the same coefficients are produced as when the integration
+* is performed on the GPU. Rather than testing each ray against every triangle that passes a
+* pre-pass, the visibility is found by traversing a bounding volume hierarchy (see BVH.h), or the
+* 8-wide hierarchy collapsed from it (see BVH8.h).
+*
+*
+* This file is part of the implimentation and is not intended for public
+* use.
+*
+*
+* Forms part of the DxPRT project
+*
+*
+*
+* Author: Shaun Bailey
+*
+* Date created: 16/10/2026
+*
+* Last Updated: 16/10/2026
+*
+*
+*
+* MIT License
+*
+* Copyright (c) 2021 Shaun Bailey
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*
+*/
+
+#pragma once
+#include <vector>
+#include "DxPRT/Platform.h"
+#include "DxPRT/GenerateGeneral_Utility.h"
+#include "DxPRT/BVH.h"
+#include "DxPRT/BVH8.h"
+#include "DxPRT/Hemicube.h"
+#include "DxPRT/Sampling.h"
+#include "DxPRT/SphericalHarmonics.h"
+
+namespace DxPRT_Utility {
+
+    // contains the constants used in the generation of the PRT coefficients on the CPU
+    struct PRTCPUConstantContainer {
+        UINT64 numEvents;
+        UINT64 shGridNum;
+        UINT64 maxL;
+        UINT64 nCoefficients;
+        UINT64 triangleNum;
+        UINT64 vertexNum;
+        UINT64 numThreads;
+        bool packetTraversal;
+        bool wideBVH;
+        bool mortonBVH;
+        bool analyticUnoccluded;
+        bool controlVariate;
+        DxPRT::VISIBILITY_MODE visibility;
+        UINT64 hemicubeResolution; // rounded, see Hemicube::RoundResolution
+        DxPRT::SAMPLING_MODE sampling;
+        UINT64 latticeGenerator; // see LatticeGenerator
+        UINT64 seed;
+        std::vector<double> cosineZonal; // the unshadowed transfer of each band l, see CalcCosineZonal
+    };
+
+
+    // contains the data and pointers to data used in the generation of the PRT coefficients on the CPU
+    struct PRTCPUDataContainer {
+        const float* pVertexData;
+        const UINT32* pIndexData;
+        const float* pNormalData;
+        BVH bvh; // not built if the 8-wide BVH or the hemicube is used
+        BVH8 wideBVH;
+        BVHBuildStats bvhStats;
+        HemicubeTriangles hemicubeTriangles; // only built if the hemicube is used
+    };
+
+
+    // buffers owned by a single thread of the CPU implementation, reused for every vertex processed
+    // by the thread. Aligned to separate cache lines, such that the threads do not share data
+    struct alignas(64) CPUThreadScratch {
+        std::vector<double> total; // running total of each coefficient
+        std::vector<float> directionX, directionY, directionZ, cosTheta;
+        std::vector<float> sortedDirections; // x, y and z components each stored contiguously
+        std::vector<UINT32> cell, cellStart, order, occluded;
+        // a block of up to SH_BLOCK_SIZE rays to be summed, the occluded rays for the control variate
+        std::vector<float> visibleX, visibleY, visibleZ, visibleWeight;
+        std::vector<float> shBlock; // spherical harmonics of a block of directions, see CalcSHDirections
+        Hemicube hemicube; // only initialized if the hemicube is used
+    };
+
+
+    // describes the frame about the vertex normal, equivalent to the RayData root constants
+    // used by the shaders. All directions are normalized
+    struct CPURayData {
+        float rayPos[3];
+        float forward[3];
+        float xDir[3];
+        float yDir[3];
+    };
+
+
+    /*
+    * InitializePRTCPUConstants: initializes the constants used in the CPU implementation of GeneratePRT.
+    * The number of events and grid points are rounded in the same way as on the GPU
+    *
+    * _IN_ desc: the PRT_DESC object passed on initialization
+    * _IN_ triangleNum: the number of triangles in the mesh
+    * _IN_ vertexNum: number of vertices in the mesh
+    */
+    PRTCPUConstantContainer InitializePRTCPUConstants(const DxPRT::PRT_DESC& desc,
+        const UINT64& triangleNum, const UINT64& vertexNum);
+
+
+    /*
+    * InitializePRTCPUDataContainer: builds the BVH over the mesh, which is collapsed into an 8-wide BVH
+    * and then freed if constants.wideBVH is set. In the hemicube mode, the triangles are instead copied
+    * for rasterization and no BVH is built. Also store the pointers to data passed
+    * to GeneratePRT. The spherical harmonics are evaluated directly, so no grids are needed on the CPU
+    *
+    * _OUT_ dataContainer: container for the data and pointers
+    * _IN_ constants: the parameters needed for data generation
+    * _IN_ vertexData: pointer to the vertex data
+    * _IN_ indexData: pointer to the index data
+    * _IN_ normalData: pointer to the normal data
+    */
+    void InitializePRTCPUDataContainer(PRTCPUDataContainer& dataContainer,
+        const PRTCPUConstantContainer& constants, const float* vertexData,
+        const UINT32* indexData, const float* normalData);
+
+
+    /*
+    * InitializeCPUThreadScratch: creates the buffers of each thread
+    *
+    * _OUT_ scratch: one set of buffers per thread
+    * _IN_ constants: the parameters needed for the integration
+    */
+    void InitializeCPUThreadScratch(std::vector<CPUThreadScratch>& scratch,
+        const PRTCPUConstantContainer& constants);
+
+
+    /*
+    * InitializeCPURayData: calculates the frame used to generate the ray directions about a vertex
+    *
+    * _OUT_ rayData: the position of the vertex and the normalized directions of the frame
+    * _IN_ pVertex: pointer to the 3 floats of the vertex position
+    * _IN_ pNormal: pointer to the 3 floats of the vertex normal
+    */
+    void InitializeCPURayData(CPURayData& rayData, const float* pVertex, const float* pNormal);
+
+
+    /*
+    * CalcCosineZonal: calculates the zonal harmonic coefficients of the transfer function of a
+    * vertex with nothing above its tangent plane. The integrator estimates 4 / pi times the
+    * integral of SH(w) * cos^2(theta) over the hemisphere, as the weight cos(theta) is applied to
+    * directions that are already cosine weighted. This is a function of the angle to the normal
+    * alone, so by the Funk-Hecke theorem coefficient (l, m) is 8 * I_l * SH_lm(normal), where I_l
+    * is the integral of t^2 * P_l(t) over [0, 1]. The integrals are found from the recurrence of
+    * the Legendre polynomials. With constants.analyticUnoccluded, this is used for the vertices
+    * with no occluders (see BVH::HasOccluders) without tracing any rays. With
+    * constants.controlVariate, the spherical harmonics of the occluded events are summed instead of
+    * the visible ones and subtracted from it
+    *
+    * _IN_ maxL: the maximum value of l
+    * returns the maxL + 1 values of 8 * I_l
+    */
+    std::vector<double> CalcCosineZonal(const UINT64& maxL);
+
+
+    /*
+    * IntegrateVertex: calculates the spherical harmonic coefficients of the transfer function of a
+    * single vertex on the calling thread, such that the vertices can be processed in parallel by
+    * the threads of a ThreadPool. The visibility of each event is found by tracing a ray through
+    * the BVH (see BVH::OccludedPacket) or from a hemicube (see Hemicube::Rasterize), and the
+    * spherical harmonics of the visible rays are summed in blocks (see CalcSHDirections). Returns
+    * true if the vertex has nothing above its tangent plane and was given the closed form transfer
+    * instead (see CalcCosineZonal)
+    *
+    * _OUT_ coefficients: pointer to where the nCoefficients coefficients of this vertex are stored
+    * _IN/OUT_ scratch: the buffers of the calling thread
+    * _IN_ data: the BVH, the 8-wide BVH if constants.wideBVH is set, or the triangles of the
+    *            hemicube mode
+    * _IN_ constants: the parameters needed to describe the integration
+    * _IN_ rayData: the frame about the vertex
+    * _IN_ iVertex: the index of the vertex, used to select its stream of random numbers
+    */
+    bool IntegrateVertex(float* coefficients, CPUThreadScratch& scratch, const PRTCPUDataContainer& data,
+        const PRTCPUConstantContainer& constants, const CPURayData& rayData, const UINT64& iVertex);
+
+}
\ No newline at end of file
@@ -54,6 +54,7 @@
 #include "DxPRT/CommandList.h"
 #include "DxPRT/CommandQueue.h"
 #include "DxPRT/SphericalHarmonics.h"
+#include "DxPRT/SHTable.h"
 #include "DxPRT/Resource.h"
 #include "DxPRT/DescriptorHeap.h"
 #include "DxPRT/PRTWriter.h"
@@ -95,6 +96,7 @@ namespace DxPRT_Utility {
         UINT64 nCoefficients;
         UINT64 triangleNum;
         UINT64 vertexNum;
+        UINT64 seed;
     };
 
 
@@ -133,7 +135,7 @@ namespace DxPRT_Utility {
         float* pVertexData;
         UINT32* pIndexData;
         float* pNormalData;
-        std::vector<std::vector<float>> shData;
+        std::shared_ptr<const SHTable> shTable;
         std::vector<UINT32> randomData;
     };
 
@@ -161,11 +163,12 @@ namespace DxPRT_Utility {
     * _IN_ normalData: pointer to the normal data
     * _IN_ numVertex: the number of vertices in the mesh
     * _IN_ triangleNum: the number of triangles in the mesh
+    * _IN_ shTable: the table passed in the PRT_DESC, used if it has the right size, may be nullptr
     */
     void InitalizePRTDataContainer(PRTDataContainer& dataContainer,
         const PRTConstantContainer& constants, float* vertexData,
         UINT32* indexData, float* normalData, const UINT64& numVertex,
-        const UINT64& triangleNum);
+        const UINT64& triangleNum, const std::shared_ptr<const SHTable>& shTable);
 
 
     /*
@@ -248,11 +251,11 @@ namespace DxPRT_Utility {
     /*
     * StorePRTResult: Stores the spherical harmonic coefficients for the transfer function
     *
-    * _OUT_ coefficients: a vector containing the resulting coefficients
+    * _OUT_ coefficients: the nCoefficients resulting coefficients of the vertex
     * _IN_ resources: contains the resources needed to copy the data from the GPU
     * _IN_ constants: contains constants needed to define the copy
     */
-    void StorePRTResult(std::vector<float>& coefficients, const PRTResourceContainer& resources,
+    void StorePRTResult(float* coefficients, const PRTResourceContainer& resources,
         const PRTConstantContainer& constants);
 
 
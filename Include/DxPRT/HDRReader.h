@@ -53,12 +53,38 @@
 #include <iostream>
 #include <fstream>
 #include <sstream>
-#include <Windows.h>
+#include <memory>
+#include "DxPRT/Platform.h"
+#include "DxPRT/MappedFile.h"
 #include <exception>
 
 
 namespace DxPRT_Utility {
 
+	static const char HDR_CACHE_MAGIC[8] = { 'D', 'x', 'P', 'R', 'T', 'h', 'd', 'r' };
+	static const UINT32 HDR_CACHE_VERSION = 1;
+	static const UINT64 HDR_CACHE_HEADER_SIZE = 64;
+
+
+	/*
+	* the header at the start of a cache file, which is written next to the hdr file with the
+	* extension .cache appended. The decoded pixels follow the header in the same layout as
+	* the data of the reader (3 floats per pixel, R32G32B32_FLOAT)
+	*/
+	struct HDRCacheHeader
+	{
+		char magic[8];
+		UINT32 version;
+		UINT32 pixelSize; // the number of bytes per pixel
+		UINT64 width;
+		UINT64 height;
+		UINT64 dataOffset; // offset of the pixels from the start of the file
+		UINT64 fileSize;
+		UINT64 sourceSize; // the size of the hdr file that was decoded
+		UINT64 sourceHash; // the checksum of the hdr file that was decoded
+	};
+
+
 	class HDRReader
 	{
 	public:
@@ -67,15 +93,19 @@ namespace DxPRT_Utility {
 		HDRReader();
 
 		// this initializer automatically calls the Load function
-		HDRReader(const std::string &fileString);
+		HDRReader(const std::string &fileString, const bool &useCache = true);
 
 		/*
-		* Load: reads the hdr file and stores the relevant data. If the file cannot be read
-		* then the function will return false.
+		* Load: reads the hdr file and stores the relevant data. If a cache file for the hdr
+		* file exists and was created from the same contents, then it is mapped and used
+		* directly. Otherwise the start of each scanline is found first, after which the
+		* scanlines of large images are decoded in parallel, and the result is written to the
+		* cache file. If the file cannot be read then the function will return false.
 		* 
 		* _IN_ fileString: path to the hdr file
+		* _IN_ useCache: if false, the hdr file is always decoded and no cache file is written
 		*/
-		bool Load(const std::string &fileString);
+		bool Load(const std::string &fileString, const bool &useCache = true);
 
 		/*
 		* GetData: returns a pointer to the hdr data. Each pixel is contains 3 floats for
@@ -97,33 +127,62 @@ namespace DxPRT_Utility {
 		/*
 		* ProcessHeader: reads the header of the hdr file. Returns false if it fails
 		* 
-		* _IN/OUT_ infile: the current file stream
+		* _IN/OUT_ p: the start of the file, set to the start of the first scanline
+		* _IN_ end: the end of the file
+		*/
+		bool ProcessHeader(const unsigned char*& p, const unsigned char* end);
+
+		/*
+		* LoadCache: maps the cache file and checks that it holds the decoded pixels of the hdr
+		* file. Returns false if not
+		* 
+		* _IN_ cacheString: path to the cache file
+		* _IN_ sourceSize: the size of the hdr file
+		* _IN_ sourceHash: the checksum of the hdr file
+		*/
+		bool LoadCache(const std::string &cacheString, const UINT64 &sourceSize,
+			const UINT64 &sourceHash);
+
+		/*
+		* WriteCache: writes the decoded pixels to the cache file. The file is written under a
+		* temporary name and then renamed, such that a partially written file is never read.
+		* Returns false if it fails
+		* 
+		* _IN_ cacheString: path to the cache file
+		* _IN_ sourceSize: the size of the hdr file
+		* _IN_ sourceHash: the checksum of the hdr file
 		*/
-		bool ProcessHeader(std::ifstream& infile);
+		bool WriteCache(const std::string &cacheString, const UINT64 &sourceSize,
+			const UINT64 &sourceHash) const;
 
 		/*
-		* DecodeByteCode: decodes the run-length encoded data into the full RGBE data
-		* Returns false if it fails.
+		* DecodeScanline: decodes a single run-length encoded scanline into its RGBE bytes, which
+		* are stored as 4 planes of width_ bytes (red, green, blue then exponent). Returns false if
+		* it fails.
 		* 
-		* _IN/OUT_ infile: the current file stream
-		* _OUT_ decodedData: vector containing the decoded data, stored as floats
+		* _IN/OUT_ p: the start of the scanline, set to the start of the next scanline
+		* _IN_ end: the end of the file
+		* _OUT_ scanline: buffer of 4 * width_ bytes, if nullptr then the scanline is only
+		* checked and skipped
 		*/
-		bool DecodeByteCode(std::ifstream& infile,
-			std::vector<float>& decodedData) const;
+		bool DecodeScanline(const unsigned char*& p, const unsigned char* end,
+			unsigned char* scanline) const;
 
 		/*
-		* GenerateData: transforms the data from the full RGBE format to the final hdr
+		* ConvertScanline: transforms a decoded scanline from the RGBE format to the final hdr
 		* RGB format
 		* 
-		* _IN_ decodedData: the full RGBE data
+		* _IN_ scanline: the decoded RGBE bytes
+		* _OUT_ pixels: the 3 * width_ floats of the scanline in data_
 		*/
-		void GenerateData(const std::vector<float>& decodedData);
+		void ConvertScanline(const unsigned char* scanline, float* pixels) const;
 
 
 		// returns an exception if the data is access before the file is loaded
 		void NotLoadedMessage() const;
 
 		std::vector<float> data_;
+		std::shared_ptr<MappedFile> cacheFile_; // holds the pixels if read from the cache, shared between copies
 		size_t lineNumber_ = 0;
 		size_t height_ = 0;
 		size_t width_ = 0;
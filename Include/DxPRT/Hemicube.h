@@ -0,0 +1,157 @@
+/*
+*
+* A software rasterized hemicube, used by the CPU implementation as an alternative to tracing rays
+* for the visibility of each vertex (see DxPRT::VISIBILITY_HEMICUBE). Every triangle of the mesh is
+* projected onto the five faces of a cube about the vertex, the top face along the normal and the
+* upper halves of the four side faces. The visibility of any direction in the hemisphere is then
+* read from the pixel of the face it passes through.
+*
+* As a ray is occluded by any triangle in front of its origin, only the coverage of each pixel is
+* stored and no depth test is needed, such that the triangles can be drawn in any order. The
+* triangles are transformed and rejected SIMD_WIDTH at a time, each triangle is clipped to the
+* frustum of each face and the pixels are stored in tiles of 8x8 bits, with whole tiles accepted or
+* rejected before the rows of partially covered tiles are tested using SIMDFloat8 (see SIMD.h).
+*
+* Triangles that contain the vertex itself are skipped, as these are never hit by the ray tracer
+* (see BVH::IntersectTriangle).
+*
+*
+* This file is part of the implimentation and is not intended for public
+* use.
+*
+*
+* Forms part of the DxPRT project
+*
+*
+*
+* Author: Shaun Bailey
+*
+* Date created: 16/10/2026
+*
+* Last Updated: 16/10/2026
+*
+*
+*
+* MIT License
+*
+* Copyright (c) 2021 Shaun Bailey
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*
+*/
+
+#pragma once
+
+#include <vector>
+#include "DxPRT/Platform.h"
+
+
+namespace DxPRT_Utility {
+
+	/*
+	* The triangles of a mesh stored such that component k of vertex j of triangle i is at
+	* vertices[(3 * j + k) * stride + i]. The stride is a multiple of SIMD_WIDTH, with the
+	* unused triangles set to zero.
+	*/
+	struct HemicubeTriangles
+	{
+		std::vector<float> vertices;
+		UINT64 triangleNum = 0;
+		UINT64 stride = 0;
+
+		/*
+		* Build: copies the triangles of a mesh
+		*
+		* _IN_ vertexData: pointer to the vertex data, this should contain 3 floats per vertex
+		* _IN_ indexData: pointer to the index data, this should contain 3 unsigned integers per triangle
+		* _IN_ triangleNum: the total number of triangles in the mesh
+		*/
+		void Build(const float* vertexData, const UINT32* indexData, const UINT64& triangleNum);
+	};
+
+
+	class Hemicube
+	{
+	public:
+
+		Hemicube();
+
+		/*
+		* Initialize: allocates the pixels of the faces
+		*
+		* _IN_ resolution: the number of pixels along each edge of a face, rounded up to a multiple of 16
+		*/
+		void Initialize(const UINT64& resolution);
+
+		/*
+		* Rasterize: clears the faces and draws every triangle as seen from a vertex, after which each
+		* event of the vertex looks up the pixel of its direction (see Occluded). Returns false if no
+		* triangle could occlude a direction of the hemisphere, such that every pixel is clear and the
+		* closed form transfer can be used as for BVH::HasOccluders
+		*
+		* _IN_ triangles: the triangles of the mesh
+		* _IN_ origin: the position of the vertex
+		* _IN_ xDir: the x direction of the frame about the vertex
+		* _IN_ yDir: the y direction of the frame about the vertex
+		* _IN_ forward: the normal of the vertex, the top face of the hemicube
+		*/
+		bool Rasterize(const HemicubeTriangles& triangles, const float* origin, const float* xDir,
+			const float* yDir, const float* forward);
+
+		/*
+		* Occluded: returns true if the pixel of the direction is covered by a triangle
+		*
+		* _IN_ x: the component of the direction along xDir
+		* _IN_ y: the component of the direction along yDir
+		* _IN_ z: the component of the direction along forward, this must be positive
+		*/
+		bool Occluded(const float& x, const float& y, const float& z) const;
+
+		// returns the number of pixels along each edge of a face
+		UINT64 GetResolution() const;
+
+		// rounds a resolution up to a multiple of 16, such that each half face is a whole number of tiles
+		static UINT64 RoundResolution(const UINT64& resolution);
+
+	private:
+
+		/*
+		* DrawTriangle: clips a triangle to the frustum of each face and sets the pixels it covers
+		*
+		* _IN_ vertices: the 3 vertices of the triangle in the frame of the vertex
+		*/
+		void DrawTriangle(const float vertices[3][3]);
+
+		/*
+		* DrawPolygon: sets the pixels of a face whose centres lie within a convex polygon
+		*
+		* _IN_ face: the face, 0 is the top face
+		* _IN_ points: the pixel coordinates of the vertices of the polygon
+		* _IN_ pointNum: the number of vertices
+		*/
+		void DrawPolygon(const int& face, const float points[][2], const int& pointNum);
+
+		UINT64 resolution_ = 0;
+		UINT64 tilesX_ = 0; // number of tiles along each row of a face
+		std::vector<UINT64> tiles_; // the top face followed by the four half side faces
+		UINT64 faceOffset_[5] = {}; // the first tile of each face
+
+	};
+
+}
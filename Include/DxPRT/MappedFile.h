@@ -0,0 +1,102 @@
+/*
+*
+* Class to map a file into memory, such that its contents can be used directly without being
+* read into a separate buffer. The mapping is private (copy-on-write), so the data may be modified
+* without changing the file. Uses the Win32 file mapping functions, or mmap on other platforms.
+*
+*
+* This file is part of the implimentation and is not intended for public
+* use.
+*
+*
+* Forms part of the DxPRT project
+*
+*
+*
+* Author: Shaun Bailey
+*
+* Date created: 16/10/2026
+*
+* Last Updated: 16/10/2026
+*
+*
+*
+* MIT License
+*
+* Copyright (c) 2021 Shaun Bailey
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*
+*/
+
+#pragma once
+
+#include "DxPRT/Platform.h"
+#include <cstddef>
+#include <string>
+
+
+namespace DxPRT_Utility {
+
+	class MappedFile
+	{
+	public:
+
+		// default constructor
+		MappedFile();
+
+		// unmaps the file
+		~MappedFile();
+
+		MappedFile(const MappedFile&) = delete;
+		MappedFile& operator=(const MappedFile&) = delete;
+
+		/*
+		* Open: maps the whole of a file into memory, any previously opened file is first unmapped.
+		* Returns false if the file cannot be opened or is empty
+		*
+		* _IN_ fileName: path to the file
+		*/
+		bool Open(const std::string& fileName);
+
+		// unmaps the file
+		void Close();
+
+		// returns a pointer to the start of the mapped file
+		char* GetData() const;
+
+		// returns the size of the file in bytes
+		size_t GetSize() const;
+
+		// returns true if a file is mapped
+		bool IsOpen() const;
+
+	private:
+
+#ifdef _WIN32
+		HANDLE file_ = INVALID_HANDLE_VALUE;
+		HANDLE mapping_ = nullptr;
+#else
+		int file_ = -1;
+#endif
+		char* data_ = nullptr;
+		size_t size_ = 0;
+	};
+
+}
@@ -46,7 +46,7 @@
 
 #pragma once
 
-#include <Windows.h>
+#include "DxPRT/Platform.h"
 #include <fstream>
 #include <iostream>
 #include <sstream>
@@ -56,6 +56,22 @@
 
 namespace DxPRT_Utility {
 
+	// used in place of an index that is not given in the file
+	static const UINT32 OBJ_NO_INDEX = 0xffffffff;
+
+
+	/*
+	* SumFaceNormals: adds the normal of each triangle, whose length is twice the area of the
+	* triangle, to the normal of each of its vertices
+	*
+	* _IN_ vertices: 3 floats per vertex
+	* _IN_ indices: 3 indices per triangle
+	* _IN_ triangleNum: the number of triangles
+	* _INOUT_ normals: 3 floats per vertex, which should be zero before the first call
+	*/
+	void SumFaceNormals(const float* vertices, const UINT32* indices, const size_t& triangleNum,
+		float* normals);
+
 	class ObjReader
 	{
 	public:
@@ -68,10 +84,15 @@ namespace DxPRT_Utility {
 
 		/*
 		* Load: reads in the data from the the .obj file and stores the data in the relavent
-		* vectors
+		* vectors. Faces may be given in any of the forms v, v/vt, v//vn or v/vt/vn, with negative
+		* indices counting back from the last element read. Polygons are split into triangles
+		* sharing their first vertex. The file is mapped into memory and large files are split at
+		* line boundaries and parsed in parallel
 		* 
 		* _IN_ fileName: the path to the .obj file
-		* _IN_ calculateNormals: if set to true, then the normal at each vertex will be calculated
+		* _IN_ calculateNormals: if set to true, then the normal at each vertex will be calculated.
+		* If every face gives a vn index then the normals in the file are used, otherwise the
+		* normals of the faces around each vertex are summed
 		*/
 		bool Load(const std::string &fileName, const bool &calculateNormals = true);
 
@@ -104,38 +125,91 @@ namespace DxPRT_Utility {
 
 	private:
 
+		// a range of whole lines of the file, which is parsed on a single thread
+		struct Chunk
+		{
+			const char* begin = nullptr;
+			const char* end = nullptr;
+
+			// the number of each element within the chunk
+			UINT64 vertexNum = 0, normalNum = 0, texCoordNum = 0, triangleNum = 0;
+
+			// the index of the next element of each type over the whole file. Before parsing this
+			// is the number of elements in the previous chunks
+			UINT64 vertexIndex = 0, normalIndex = 0, texCoordIndex = 0, triangleIndex = 0;
+
+			bool allFacesHaveNormals = true;
+		};
+
+		/*
+		* CountChunk: counts the elements of each type in the chunk, such that the vectors can be
+		* allocated before the file is parsed
+		*
+		* _INOUT_ chunk: the chunk to count
+		*/
+		void CountChunk(Chunk& chunk) const;
+
+		/*
+		* ParseChunk: parses each line of the chunk into its place in the vectors. Returns false
+		* if the read fails
+		*
+		* _INOUT_ chunk: the counted chunk
+		*/
+		bool ParseChunk(Chunk& chunk);
+
 		/*
 		* ProcessLine: processes a single line of the .obj file and passes it to the relevant
 		* funtion depending on the specifier. Returns false if the read fails.
 		* 
-		* _IN_ specifier: the character(s) specifing what data is contained in the line
-		* _IN_ line: the data contained within the line
+		* _IN_ p: the start of the line
+		* _IN_ lineEnd: the end of the line
+		* _INOUT_ chunk: the chunk containing the line
 		*/
-		bool ProcessLine(const std::string& specifier,
-			const std::vector<std::string>& line);
+		bool ProcessLine(const char* p, const char* lineEnd, Chunk& chunk);
 
 		/*
-		* SetVertex: processes a line with the 'v' specifier. Returns false if failed
+		* SetVertex: processes a line with the 'v' specifier. Any values after the first 3 (e.g. w
+		* or a colour) are ignored. Returns false if failed
 		* 
-		* _IN_ line: data in the line
+		* _IN_ p: the end of the specifier
+		* _IN_ lineEnd: the end of the line
+		* _INOUT_ chunk: the chunk containing the line
+		*/
+		bool SetVertex(const char* p, const char* lineEnd, Chunk& chunk);
+
+		/*
+		* SetNormal: processes a line with the 'vn' specifier. Returns false if failed
+		*
+		* _IN_ p: the end of the specifier
+		* _IN_ lineEnd: the end of the line
+		* _INOUT_ chunk: the chunk containing the line
 		*/
-		bool SetVertex(const std::vector<std::string>& line);
+		bool SetNormal(const char* p, const char* lineEnd, Chunk& chunk);
 
 		/*
 		* SetIndex: processes a line with the 'f' specifier. Returns false if failed
 		*
-		* _IN_ line: data in the line
+		* _IN_ p: the end of the specifier
+		* _IN_ lineEnd: the end of the line
+		* _INOUT_ chunk: the chunk containing the line
 		*/
-		bool SetIndex(const std::vector<std::string>& line);
+		bool SetIndex(const char* p, const char* lineEnd, Chunk& chunk);
 
 		/*
-		* CalcNormal: calculates the normal to a paritcular face and adds it to the normals
-		* at each vertex such that after all faces are process, each vertex will have the
-		* correct normal
+		* ParseCorner: parses a single corner of a face (v, v/vt, v//vn or v/vt/vn). Returns a
+		* pointer to the character after the corner, or nullptr if it is not valid
 		*
-		* _IN_ line: data in the line
+		* _IN_ p: the start of the corner
+		* _IN_ lineEnd: the end of the line
+		* _IN_ chunk: the chunk containing the line, used to resolve negative indices
+		* _OUT_ vertex: the zero based index of the vertex
+		* _OUT_ normal: the zero based index of the normal, or OBJ_NO_INDEX if not given
 		*/
-		bool CalcNormal(const std::vector<std::string>& line);
+		const char* ParseCorner(const char* p, const char* lineEnd, const Chunk& chunk,
+			UINT32& vertex, UINT32& normal) const;
+
+		// calculates the normal at each vertex once all of the faces are read
+		void CalcNormals();
 
 		//Calculates the interleaved vector
 		void CalcInterleaved();
@@ -150,6 +224,13 @@ namespace DxPRT_Utility {
 		std::vector<float> interleaved_;
 		std::vector<UINT32> indices_;
 
+		// the 'vn' lines are indexed separately to the vertices, and are only stored when
+		// calculating normals
+		std::vector<float> fileNormals_;
+		std::vector<UINT32> normalIndices_; // the vn index of each entry of indices_
+		bool allFacesHaveNormals_ = true;
+		UINT64 normalNum_ = 0, texCoordNum_ = 0; // used to check the vn and vt indices
+
 		bool isLoaded_ = false;
 	};
 
@@ -0,0 +1,177 @@
+/*
+*
+* Definition of the binary .prt format, which is written by PRTWriter and read by PRTReader
+* alongside the original text format.
+*
+* The file starts with a PRTBinaryHeader padded to PRT_BINARY_HEADER_SIZE bytes, followed by the
+* vertex, index and coefficient sections. Each section starts at a multiple of
+* PRT_BINARY_ALIGNMENT bytes and is padded with zeros to the next multiple, such that a mapped
+* file can be used directly. The vertices are stored as NumberedVertex structs, the layout of the
+* vertex buffer used by the shaders, and the coefficients of each vertex are stored contiguously.
+* Files containing an environment map have no vertices or indices. All values are little-endian.
+*
+* The header contains a checksum of everything after it (see PRTChecksum), which is checked on
+* reading.
+*
+* While a file is still being written by PRTStreamWriter, the header has
+* PRT_BINARY_FLAG_INCOMPLETE set and the file is followed by a record of the vertices that have
+* been written so far, such that an interrupted bake can be resumed. Such files are never read.
+*
+*
+* This file is part of the implimentation and is not intended for public
+* use.
+*
+*
+* Forms part of the DxPRT project
+*
+*
+*
+* Author: Shaun Bailey
+*
+* Date created: 16/10/2026
+*
+* Last Updated: 16/10/2026
+*
+*
+*
+* MIT License
+*
+* Copyright (c) 2021 Shaun Bailey
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*
+*/
+
+#pragma once
+
+#include "DxPRT/Platform.h"
+#include <cstddef>
+
+
+namespace DxPRT_Utility {
+
+	/*
+	* this struct used to store the indexed data, where each vertex constains
+	* an index that can be used to read the spherical harmonic coefficients from
+	* a buffer
+	*/
+	struct NumberedVertex 
+	{
+		float vertex[3];
+		UINT32 index;
+	};
+
+
+	static const char PRT_BINARY_MAGIC[8] = { 'D', 'x', 'P', 'R', 'T', 'b', 'i', 'n' };
+	static const UINT32 PRT_BINARY_VERSION = 1;
+	static const UINT64 PRT_BINARY_HEADER_SIZE = 128;
+	static const UINT64 PRT_BINARY_ALIGNMENT = 64;
+
+	// the largest value of l accepted when reading a .prt file, text or binary, such that the
+	// number of coefficients cannot overflow
+	static const UINT64 PRT_MAX_L = 64;
+
+	// set in the flags of the header if the file contains an environment map
+	static const UINT32 PRT_BINARY_FLAG_EM = 0x1;
+
+	// set in the flags of the header while the coefficients are still being written
+	static const UINT32 PRT_BINARY_FLAG_INCOMPLETE = 0x2;
+
+
+	// the header at the start of a binary .prt file, the offsets are from the start of the file
+	struct PRTBinaryHeader
+	{
+		char magic[8];
+		UINT32 version;
+		UINT32 flags;
+		UINT64 maxL;
+		UINT64 vertexNum; // the number of NumberedVertex structs
+		UINT64 indexNum; // the number of indices (3 * the number of triangles)
+		UINT64 coefficientNum; // the number of floats in the coefficient section
+		UINT64 vertexOffset;
+		UINT64 indexOffset;
+		UINT64 coefficientOffset;
+		UINT64 fileSize;
+		UINT64 checksum;
+	};
+
+
+	// running state of a checksum, FNV-1a applied to 8 bytes at a time
+	struct PRTChecksum
+	{
+		UINT64 hash = 0xcbf29ce484222325ull;
+		UINT64 word = 0; // bytes that do not yet fill a whole word
+		UINT32 byteNum = 0;
+	};
+
+
+	/*
+	* InitializePRTBinaryHeader: fills in the header of a file with the given contents, including
+	* the offset of each section. The checksum is set to 0
+	*
+	* _OUT_ header: the header of the file
+	* _IN_ maxL: the maximum value of l of the spherical harmonic coefficients
+	* _IN_ vertexNum: the number of vertices
+	* _IN_ indexNum: the number of indices
+	* _IN_ coefficientNum: the total number of coefficients
+	* _IN_ isEM: true if the file contains an environment map
+	*/
+	void InitializePRTBinaryHeader(PRTBinaryHeader& header, const UINT64& maxL, const UINT64& vertexNum,
+		const UINT64& indexNum, const UINT64& coefficientNum, const bool& isEM);
+
+
+	/*
+	* CheckPRTBinaryHeader: checks that the header was written by a supported version and that the
+	* sections are consistent with each other and with the size of the file. Returns false if not
+	*
+	* _IN_ header: the header read from the file
+	* _IN_ fileSize: the size of the file in bytes
+	* _IN_ isEM: true if the file should contain an environment map
+	*/
+	bool CheckPRTBinaryHeader(const PRTBinaryHeader& header, const UINT64& fileSize, const bool& isEM);
+
+
+	/*
+	* IsPRTBinary: returns true if the data starts with the magic number of a binary .prt file
+	*
+	* _IN_ data: the start of the file
+	* _IN_ size: the number of bytes available
+	*/
+	bool IsPRTBinary(const char* data, const size_t& size);
+
+
+	/*
+	* UpdatePRTChecksum: adds data to the checksum
+	*
+	* _IN/OUT_ checksum: the running checksum
+	* _IN_ data: pointer to the data
+	* _IN_ size: the number of bytes
+	*/
+	void UpdatePRTChecksum(PRTChecksum& checksum, const void* data, const size_t& size);
+
+
+	/*
+	* FinalizePRTChecksum: returns the checksum of all of the data added, where any remaining bytes
+	* are padded with zeros to a whole word
+	*
+	* _IN_ checksum: the running checksum
+	*/
+	UINT64 FinalizePRTChecksum(const PRTChecksum& checksum);
+
+}
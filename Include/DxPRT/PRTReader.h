@@ -46,26 +46,18 @@
 
 #pragma once
 
-#include <Windows.h>
+#include "DxPRT/Platform.h"
+#include "DxPRT/MappedFile.h"
+#include "DxPRT/PRTBinary.h"
 #include <fstream>
 #include <iostream>
+#include <memory>
 #include <sstream>
 #include <string>
 #include <vector>
 
 namespace DxPRT_Utility {
 
-	/*
-	* this struct used to store the indexed data, where each vertex constains
-	* an index that can be used to read the spherical harmonic coefficients from
-	* a buffer
-	*/
-	struct NumberedVertex 
-	{
-		float vertex[3];
-		UINT32 index;
-	};
-
 	class PRTReader
 	{
 	public:
@@ -79,7 +71,9 @@ namespace DxPRT_Utility {
 
 
 		/*
-		* Load: reads the .prt file and stores the data in the relevant vectors
+		* Load: reads the .prt file and stores the data in the relevant vectors. Binary files
+		* (see PRTBinary.h) are detected automatically and mapped into memory, in which case the
+		* data are accessed directly from the mapped file without being parsed
 		* 
 		* _IN_ fileName: path to the .prt file
 		* _IN_ isEM: should be set to true if the file stores information about 
@@ -127,41 +121,32 @@ namespace DxPRT_Utility {
 	private:
 
 		/*
-		* ProcessLine: processes a single line of the .prt file and passes it to the relevant
-		* funtion depending on the specifier. Returns false if the read fails.
+		* LoadBinary: checks the header and checksum of the binary .prt file in mappedFile_.
+		* Returns false if the file is not valid
 		*
-		* _IN_ specifier: the character(s) specifing what data is contained in the line
-		* _IN_ line: the data contained within the line
+		* _IN_ isEM: should be set to true if the file stores information about
+		*            an environment map
 		*/
-		bool ProcessLine(const std::string& specifier,
-			const std::vector<std::string>& line);
-
+		bool LoadBinary(const bool& isEM);
 
 		/*
-		* ProcessLine: processes a single line of the .obj file and passes it to the relevant
-		* funtion depending on the specifier. Designed for files containing an 
-		* environment map. Returns false if the read fails.
+		* LoadText: parses a text .prt file. The lines are first counted such that the vectors
+		* can be sized, then the file is split at line boundaries and the chunks parsed in
+		* parallel. Returns false if the read fails
 		*
-		* _IN_ specifier: the character(s) specifing what data is contained in the line
-		* _IN_ line: the data contained within the line
+		* _IN_ data: the contents of the file
+		* _IN_ size: the size of the file in bytes
 		*/
-		bool ProcessLineEM(const std::string& specifier,
-			const std::vector<std::string>& line);
-
+		bool LoadText(const char* data, const size_t& size);
 
 		/*
-		* SetVertex: processes a line with the 'v' specifier. Returns false if failed
+		* LoadTextEM: parses a text .prt file containing an environment map. Returns false if
+		* the read fails
 		*
-		* _IN_ line: data in the line
+		* _IN_ data: the contents of the file
+		* _IN_ size: the size of the file in bytes
 		*/
-		bool SetVertex(const std::vector<std::string>& line);
-		
-		/*
-		* SetIndex: processes a line with the 'f' specifier. Returns false if failed
-		*
-		* _IN_ line: data in the line
-		*/
-		bool SetIndex(const std::vector<std::string>& line);
+		bool LoadTextEM(const char* data, const size_t& size);
 		
 		// calculates the indexed vertex vector
 		void CalcNumberedVertices();
@@ -177,6 +162,10 @@ namespace DxPRT_Utility {
 		size_t nCoefficients_ = 0, maxL_ = 0;
 
 		bool isLoaded_ = false, maxLFound_ = false;
+
+		bool isBinary_ = false;
+		std::shared_ptr<MappedFile> mappedFile_; // shared between copies of the reader
+		PRTBinaryHeader header_ = {};
 	};
 
 }
\ No newline at end of file
@@ -45,10 +45,15 @@
 */
 #pragma once
 
-#include <Windows.h>
+#include "DxPRT/Platform.h"
+#include "DxPRT/GenerateDesc.h"
+#include "DxPRT/PRTBinary.h"
+#include <atomic>
 #include <iostream>
 #include <fstream>
+#include <mutex>
 #include <string>
+#include <vector>
 
 
 namespace DxPRT_Utility {
@@ -68,8 +73,10 @@ namespace DxPRT_Utility {
 		* _IN_ fileName: path to the file
 		* _IN_ isEM: if set to true, then the output file will contain an environment
 		*            map
+		* _IN_ format: either the text format or the binary format (see PRTBinary.h)
 		*/
-		bool Write(const std::string &filename, const bool &isEM = false);
+		bool Write(const std::string &filename, const bool &isEM = false,
+			const DxPRT::PRT_FILE_FORMAT& format = DxPRT::PRT_FILE_FORMAT_TEXT);
 
 
 		/*
@@ -100,9 +107,19 @@ namespace DxPRT_Utility {
 
 	private:
 
+		/*
+		* writeBinary: writes the data in the binary format, the sections are written in order
+		* and the header is written last, once the checksum is known
+		*
+		* _IN/OUT_ file: the file being written, opened in binary mode
+		* _IN_ isEM: if set to true, then the output file will contain an environment map
+		*/
+		bool writeBinary(std::ofstream& file, const bool& isEM) const;
+
 		/*
 		* writeVertices: writes a line containing information about a vertex (both position
-		* and coefficients)
+		* and coefficients). Each number is written in the shortest form that is read back
+		* exactly, and blocks of lines are formatted in parallel
 		* 
 		* _IN/OUT_ file: the file being written
 		*/
@@ -133,4 +150,110 @@ namespace DxPRT_Utility {
 
 	};
 
+
+	/*
+	* Class to write a binary prt file while the coefficients are still being calculated. The
+	* vertices and indices are written when the file is opened, after which ranges of vertices
+	* can be added in any order, and from any thread, as their coefficients are completed. Each
+	* range is written straight to its final offset in the file, so only the coefficients of the
+	* ranges in flight need to be held in memory. Until the file is finished, the header is
+	* marked as incomplete, such that it is never read as a valid file, and a record of the
+	* vertices written so far is kept after the coefficients, such that a bake that is
+	* interrupted can be resumed
+	*/
+	class PRTStreamWriter
+	{
+
+	public:
+
+		// default constructor
+		PRTStreamWriter();
+
+		PRTStreamWriter(const PRTStreamWriter&) = delete;
+		PRTStreamWriter& operator=(const PRTStreamWriter&) = delete;
+
+		/*
+		* Open: creates the file and writes the vertices and indices. Returns false if the
+		* file cannot be written
+		*
+		* _IN_ fileName: path to the file
+		* _IN_ maxL: the maximum value of l for the sphierical harmonic coefficients
+		* _IN_ pVertex: pointer to the vertex data
+		* _IN_ vertexSize: number of elements in the vertex data (i.e. 3 * number of vertices)
+		* _IN_ pIndex: pointer to the index data
+		* _IN_ indexSize: number of elements in the index data (i.e. 3 * number of triangles)
+		* _IN_ settingsKey: identifies the settings used to calculate the coefficients, such that
+		*                  Resume only keeps the coefficients of the same settings
+		*/
+		bool Open(const std::string& fileName, const int& maxL, const float* pVertex,
+			const size_t& vertexSize, const UINT32* pIndex, const size_t& indexSize,
+			const UINT64& settingsKey = 0);
+
+		/*
+		* Resume: opens a file left unfinished by an earlier Open with the same mesh, maxL and
+		* settingsKey, keeping the vertices that it recorded as written (see IsRangeWritten).
+		* If there is no such file, this is the same as Open. Returns false if the file cannot
+		* be written
+		*
+		* the arguments are the same as those of Open
+		*/
+		bool Resume(const std::string& fileName, const int& maxL, const float* pVertex,
+			const size_t& vertexSize, const UINT32* pIndex, const size_t& indexSize,
+			const UINT64& settingsKey = 0);
+
+		/*
+		* WriteVertices: writes the coefficients of a range of vertices to the file. Returns
+		* false if the range is not valid or the file cannot be written
+		*
+		* _IN_ begin: the index of the first vertex of the range
+		* _IN_ end: one past the index of the last vertex of the range
+		* _IN_ pCoefficient: the (maxL+1)^2 coefficients of each vertex in the range
+		*/
+		bool WriteVertices(const UINT64& begin, const UINT64& end, const float* pCoefficient);
+
+		/*
+		* Finish: once every vertex has been written, calculates the checksum and writes the
+		* header, which completes the file. Returns false if any vertex is missing or the file
+		* cannot be written
+		*/
+		bool Finish();
+
+		// returns true if every vertex in [begin, end) has been written, including by an earlier
+		// bake that was resumed
+		bool IsRangeWritten(const UINT64& begin, const UINT64& end);
+
+		// returns the number of vertices whose coefficients have been written
+		UINT64 GetNumVerticesWritten() const;
+
+		// returns the total number of vertices
+		UINT64 GetNumVertices() const;
+
+	private:
+
+		// implements Open and Resume, the record of an earlier file is only read if resume is set
+		bool open(const std::string& fileName, const int& maxL, const float* pVertex,
+			const size_t& vertexSize, const UINT32* pIndex, const size_t& indexSize,
+			const UINT64& settingsKey, const bool& resume);
+
+		// reopens an unfinished file that matches header_ and settingsKey and reads its record of
+		// written vertices, after writing the mesh sections again. Returns false if there is no
+		// such file
+		bool resumeFile(const float* pVertex, const UINT32* pIndex, const UINT64& settingsKey);
+
+		// writes the part of the record of written vertices that covers [begin, end)
+		bool writeRecord(const UINT64& begin, const UINT64& end);
+
+		std::fstream file_;
+		std::string fileName_;
+		std::mutex mutex_; // guards the file and written_
+
+		PRTBinaryHeader header_ = {};
+		PRTChecksum checksum_; // checksum of the sections before the coefficients
+		std::vector<UINT8> written_; // a bit for each vertex that has been written
+		std::atomic<UINT64> verticesWritten_{ 0 };
+		UINT64 nCoefficients_ = 0;
+		bool isOpen_ = false;
+
+	};
+
 }
\ No newline at end of file
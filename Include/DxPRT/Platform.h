@@ -0,0 +1,71 @@
+/*
+*
+* Platform specific definitions. On Windows this simply includes the Win32 headers, on other
+* platforms the few Win32 types and functions used outside of the DirectX12 code are defined
+* such that the file readers/writers and the CPU implementation of GeneratePRT can be built
+* without the Windows SDK (see GeneratePRT_CPU.h).
+*
+*
+* This file is part of the implimentation and is not intended for public
+* use.
+*
+*
+* Forms part of the DxPRT project
+*
+*
+*
+* Author: Shaun Bailey
+*
+* Date created: 16/10/2026
+*
+* Last Updated: 16/10/2026
+*
+*
+*
+* MIT License
+*
+* Copyright (c) 2021 Shaun Bailey
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*
+*/
+
+#pragma once
+
+#ifdef _WIN32
+
+#include <Windows.h>
+
+#else
+
+#include <cstdint>
+#include <iostream>
+
+typedef std::uint8_t UINT8;
+typedef std::uint32_t UINT32;
+typedef std::uint64_t UINT64;
+typedef std::int64_t INT64;
+typedef unsigned int UINT;
+
+// debug messages are sent to the standard error stream when there is no debugger output
+inline void OutputDebugStringA(const char* message) {
+	std::cerr << message;
+}
+
+#endif
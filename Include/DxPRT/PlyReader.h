@@ -0,0 +1,184 @@
+/*
+*
+* Class to read in meshes from a binary little-endian .ply file. The file is mapped into memory and
+* the vertex and face elements are copied straight into the final vectors, with no text conversion.
+*
+*
+* This class is part of the implimentation and is not intended for public
+* use.
+*
+*
+* Forms part of the DxPRT project
+*
+*
+*
+* Author: Shaun Bailey
+*
+* Date created: 16/10/2026
+*
+* Last Updated: 16/10/2026
+*
+*
+*
+* MIT License
+*
+* Copyright (c) 2021 Shaun Bailey
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*
+*/
+
+#pragma once
+
+#include "DxPRT/Platform.h"
+#include <string>
+#include <vector>
+
+
+namespace DxPRT_Utility {
+
+	// the types of the properties in a .ply file
+	enum PLY_TYPE
+	{
+		PLY_TYPE_INT8,
+		PLY_TYPE_UINT8,
+		PLY_TYPE_INT16,
+		PLY_TYPE_UINT16,
+		PLY_TYPE_INT32,
+		PLY_TYPE_UINT32,
+		PLY_TYPE_FLOAT32,
+		PLY_TYPE_FLOAT64
+	};
+
+	// a property of an element as given in the header, lists store their length before the values
+	struct PlyProperty
+	{
+		std::string name;
+		PLY_TYPE type = PLY_TYPE_FLOAT32;
+		bool isList = false;
+		PLY_TYPE countType = PLY_TYPE_UINT8;
+	};
+
+	// an element as given in the header, the data of the elements follow the header in this order
+	struct PlyElement
+	{
+		std::string name;
+		UINT64 count = 0;
+		std::vector<PlyProperty> properties;
+	};
+
+	// returns true if the file name has the .ply extension (in any case)
+	bool IsPlyFile(const std::string& fileName);
+
+
+	class PlyReader
+	{
+	public:
+
+		// constructor that automatically calls the Load function
+		PlyReader(const std::string &fileName, const bool &calculateNormals = true);
+
+		// default constructor
+		PlyReader();
+
+		/*
+		* Load: reads in the mesh from a binary little-endian .ply file. The vertex element must
+		* have x, y and z properties, and the face element a list property named vertex_indices
+		* (or vertex_index). Other properties and elements are skipped. Polygons are split into
+		* triangles sharing their first vertex
+		*
+		* _IN_ fileName: the path to the .ply file
+		* _IN_ calculateNormals: if set to true, then the normal at each vertex will be calculated.
+		* The nx, ny and nz properties are used if the vertices have them, otherwise the normals
+		* of the faces around each vertex are summed
+		*/
+		bool Load(const std::string &fileName, const bool &calculateNormals = true);
+
+		// returns a pointer to the vertex data
+		float* GetVertices();
+
+		// returns a pointer to the index data
+		UINT32* GetIndices();
+
+		// returns a pointer to the normal data (calculate normals must have been set to true)
+		float* GetNormals();
+
+		// returns the size of the vertex data (i.e. 3 * num vertices)
+		size_t GetSizeVertices() const;
+
+		// returns the size of the index data (i.e. 3 * num triangles)
+		size_t GetSizeIndices() const;
+
+		// returns the size of the normal data (i.e. 3 * num vertices)
+		size_t GetSizeNormals() const;
+
+	private:
+
+		/*
+		* ProcessHeader: reads the header of the file. Returns false if the file is not a binary
+		* little-endian .ply file or the header is not valid
+		*
+		* _INOUT_ p: the start of the file, set to the start of the data following the header
+		* _IN_ end: the end of the file
+		* _OUT_ elements: the elements given in the header
+		*/
+		bool ProcessHeader(const char*& p, const char* end, std::vector<PlyElement>& elements) const;
+
+		/*
+		* ReadVertices: copies the positions (and normals) of the vertex element. Returns false if
+		* the element is not valid
+		*
+		* _IN_ element: the vertex element
+		* _INOUT_ p: the start of the element, set to the end of the element
+		* _IN_ end: the end of the file
+		*/
+		bool ReadVertices(const PlyElement& element, const char*& p, const char* end);
+
+		/*
+		* ReadFaces: copies the indices of the face element. Returns false if the element is not
+		* valid
+		*
+		* _IN_ element: the face element
+		* _INOUT_ p: the start of the element, set to the end of the element
+		* _IN_ end: the end of the file
+		*/
+		bool ReadFaces(const PlyElement& element, const char*& p, const char* end);
+
+		/*
+		* SkipElement: moves past an element that is not used. Returns false if the element
+		* extends past the end of the file
+		*
+		* _IN_ element: the element to skip
+		* _INOUT_ p: the start of the element, set to the end of the element
+		* _IN_ end: the end of the file
+		*/
+		bool SkipElement(const PlyElement& element, const char*& p, const char* end) const;
+
+		// produces an error if data is accessed when the object is not loaded
+		void NotLoadedMessage() const;
+
+		bool calcNormals_ = false;
+		std::vector<float> vertices_;
+		std::vector<float> normals_;
+		std::vector<UINT32> indices_;
+
+		bool isLoaded_ = false;
+	};
+
+}
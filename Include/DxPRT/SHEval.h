@@ -0,0 +1,184 @@
+/*
+*
+* Spherical harmonics evaluated by functions specialized at compile time for each maximum
+* value of l up to SH_EVAL_MAX_L. The recurrences of SphericalHarmonics.cpp are unrolled by the
+* compiler, with every normalization and recurrence coefficient evaluated as a constant
+* expression, such that each spherical harmonic is a polynomial in the Cartesian components of
+* the direction. No memory is allocated and no trigonometric functions are called.
+*
+* The conventions are the same as CalcSH: theta is measured from the y-axis and phi =
+* atan2(z, x) + pi, with the value of l, m stored at index l * l + l + m.
+*
+* The evaluators are templated on the type of the values, which is either a float for a single
+* direction or a SIMDFloat for SIMD_WIDTH directions at once (see SIMD.h).
+*
+*
+* This file is part of the implimentation and is not intended for public
+* use.
+*
+*
+* Forms part of the DxPRT project
+*
+*
+*
+* Author: Shaun Bailey
+*
+* Date created: 16/10/2026
+*
+* Last Updated: 16/10/2026
+*
+*
+*
+* MIT License
+*
+* Copyright (c) 2021 Shaun Bailey
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*
+*/
+
+#pragma once
+
+#include <cstddef>
+#include "DxPRT/SIMD.h"
+
+
+namespace DxPRT_Utility {
+
+	// the largest value of l with a specialized evaluator, larger values use the general recurrences
+	static const size_t SH_EVAL_MAX_L = 8;
+
+
+	// square root by Newton's method, such that it can be used in a constant expression
+	constexpr double SHEvalSqrt(const double& x)
+	{
+		double res = x > 1.0 ? x : 1.0;
+		for (int i = 0; i < 64; ++i)
+		{
+			res = 0.5 * (res + x / res);
+		}
+		return res;
+	}
+
+
+	// a constant with the type of the values being evaluated
+	template <typename T> inline T SHEvalSet(const float& x);
+	template <> inline float SHEvalSet<float>(const float& x) { return x; }
+	template <> inline SIMDFloat SHEvalSet<SIMDFloat>(const float& x) { return SIMDSet(x); }
+
+
+	/*
+	* SHEvalConstant: the normalization of the spherical harmonic (see CalcCoefficient) multiplied by
+	* the Legendre function at l = m divided by sin(theta)^m, (-1)^m (2m - 1)!!
+	*
+	* _IN_ l
+	* _IN_ m: m >= 0, the constant of -m is the same
+	*/
+	constexpr double SHEvalConstant(const size_t& l, const size_t& m)
+	{
+		const double PI = 3.14159265358979;
+		double res = (2.0 * l + 1.0) / (4.0 * PI);
+		for (size_t k = l - m + 1; k <= l + m; ++k)
+		{
+			res /= double(k);
+		}
+		res = SHEvalSqrt(res);
+		if (m > 0) res *= SHEvalSqrt(2.0);
+
+		for (size_t k = 1; k <= m; ++k)
+		{
+			res *= -double(2 * k - 1);
+		}
+		return res;
+	}
+
+
+	// evaluates the spherical harmonics of order M from l up to L, with P1 and P2 the Legendre
+	// functions of l - 1 and l - 2 divided by that of l = M (the value of which is 1)
+	template <size_t L, size_t M, size_t l, typename T>
+	inline void SHEvalDegree(const T& y, const T& cosine, const T& sine,
+		const T& P1, const T& P2, T* result)
+	{
+		constexpr float K = float(SHEvalConstant(l, M));
+
+		T P;
+		if constexpr (l == M)
+		{
+			P = SHEvalSet<T>(1.0f);
+		}
+		else if constexpr (l == M + 1)
+		{
+			P = SHEvalSet<T>(float(2 * M + 1)) * y;
+		}
+		else
+		{
+			constexpr float A = float(2 * l - 1) / float(l - M);
+			constexpr float B = float(l + M - 1) / float(l - M);
+			P = SHEvalSet<T>(A) * y * P1 - SHEvalSet<T>(B) * P2;
+		}
+
+		if constexpr (M == 0)
+		{
+			result[l * l + l] = SHEvalSet<T>(K) * P;
+		}
+		else
+		{
+			T KP = SHEvalSet<T>(K) * P;
+			result[l * l + l + M] = KP * cosine;
+			result[l * l + l - M] = KP * sine;
+		}
+
+		if constexpr (l < L) SHEvalDegree<L, M, l + 1>(y, cosine, sine, P, P1, result);
+	}
+
+
+	// evaluates the spherical harmonics of order M and above, cosine and sine are
+	// sin(theta)^M cos(M phi) and sin(theta)^M sin(M phi), the real and imaginary parts of (-x - iz)^M
+	template <size_t L, size_t M, typename T>
+	inline void SHEvalOrder(const T& negX, const T& y, const T& negZ,
+		const T& cosine, const T& sine, T* result)
+	{
+		SHEvalDegree<L, M, M>(y, cosine, sine, y, y, result); // P1 and P2 are not used when l = M
+
+		if constexpr (M < L)
+		{
+			SHEvalOrder<L, M + 1>(negX, y, negZ, cosine * negX - sine * negZ, sine * negX + cosine * negZ, result);
+		}
+	}
+
+
+	/*
+	* SHEval: calculates the spherical harmonics up to l = L of a single direction, or of SIMD_WIDTH
+	* directions when T is a SIMDFloat
+	*
+	* _IN_ x: the x component of the (normalized) direction
+	* _IN_ y: the y component of the direction
+	* _IN_ z: the z component of the direction
+	* _OUT_ result: (L + 1)^2 values containing the spherical harmonics
+	*/
+	template <size_t L, typename T = float>
+	inline void SHEval(const T& x, const T& y, const T& z, T* result)
+	{
+		static_assert(L <= SH_EVAL_MAX_L, "DxPRT: SHEval is only specialized up to SH_EVAL_MAX_L");
+		T zero = SHEvalSet<T>(0.0f);
+		T one = SHEvalSet<T>(1.0f);
+		SHEvalOrder<L, 0>(zero - x, y, zero - z, one, zero, result);
+	}
+
+}
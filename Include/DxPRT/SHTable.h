@@ -0,0 +1,124 @@
+/*
+*
+* A class containing the grids of spherical harmonics sampled by the shaders. Every grid is
+* stored in a single preallocated block of memory, and the rows are evaluated in parallel with
+* the batched spherical harmonics (see CalcSHAngles). Grid points are placed at the texel
+* centres of the linear clamp sampler, such that a lookup at theta / pi and phi / (2 pi) returns
+* the spherical harmonic at that direction.
+*
+* Tables are expensive to build for large grids, so a shared table of each size is cached and
+* can be reused between calls to GenerateEM and GeneratePRT (see GetShared).
+*
+*
+* This file is part of the implimentation and is not intended for public
+* use.
+*
+*
+* Forms part of the DxPRT project
+*
+*
+*
+* Author: Shaun Bailey
+*
+* Date created: 16/10/2026
+*
+* Last Updated: 16/10/2026
+*
+*
+*
+* MIT License
+*
+* Copyright (c) 2021 Shaun Bailey
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*
+*/
+
+#pragma once
+
+#include <memory>
+#include <vector>
+#include "DxPRT/Platform.h"
+
+
+namespace DxPRT_Utility {
+
+	class SHTable
+	{
+	public:
+
+		SHTable();
+
+		// constructor that automatically calls the Build function
+		SHTable(const UINT64& shGridNum, const UINT64& maxL, const UINT64& numThreads = 0);
+
+		/*
+		* Build: evaluates the grids of every spherical harmonic up to maxL. The grid of each l and m
+		* is stored with theta varying along a row and phi between rows, the same layout as the textures
+		*
+		* _IN_ shGridNum: the number of grid points in both the theta and phi directions
+		* _IN_ maxL: the maximum value of l
+		* _IN_ numThreads: the number of threads used, if 0 then every hardware thread is used
+		*/
+		void Build(const UINT64& shGridNum, const UINT64& maxL, const UINT64& numThreads = 0);
+
+		/*
+		* GetShared: returns a table with the given size. If a table of this size is still in use by
+		* another call, then it is returned rather than built again. Only weak references are kept, such
+		* that each table is freed once it is no longer in use. The table is built without holding the
+		* lock, so requests for other sizes do not wait
+		*
+		* _IN_ shGridNum: the number of grid points in both the theta and phi directions
+		* _IN_ maxL: the maximum value of l
+		*/
+		static std::shared_ptr<const SHTable> GetShared(const UINT64& shGridNum, const UINT64& maxL);
+
+		/*
+		* GetShared: returns table if it has the given size, such as a table passed in the EM_DESC or
+		* PRT_DESC to be reused between bakes. Otherwise the table is found as above
+		*
+		* _IN_ shGridNum: the number of grid points in both the theta and phi directions
+		* _IN_ maxL: the maximum value of l
+		* _IN_ table: the table provided by the caller, may be nullptr
+		*/
+		static std::shared_ptr<const SHTable> GetShared(const UINT64& shGridNum, const UINT64& maxL,
+			const std::shared_ptr<const SHTable>& table);
+
+		// returns true if the table is built with the given size
+		bool Matches(const UINT64& shGridNum, const UINT64& maxL) const;
+
+		// returns a pointer to the shGridNum * shGridNum floats of the grid of a single l and m
+		const float* GetGrid(const UINT64& iCoefficient) const;
+
+		UINT64 GetSHGridNum() const;
+		UINT64 GetMaxL() const;
+		UINT64 GetNCoefficients() const;
+
+	private:
+
+		void NotBuiltMessage() const;
+
+		bool isBuilt_ = false;
+		UINT64 shGridNum_ = 0;
+		UINT64 maxL_ = 0;
+		UINT64 nCoefficients_ = 0;
+		std::vector<float> data_; // the grid of coefficient k starts at k * shGridNum * shGridNum
+	};
+
+}
@@ -0,0 +1,230 @@
+/*
+*
+* A thin wrapper around the SIMD instructions used by the CPU implementation. The widest instruction
+* set enabled by the compiler is chosen when building: AVX-512 (16 floats), AVX2 (8 floats) or
+* SSE (4 floats). If none of these are available, then a scalar implementation with 4 lanes is used
+* such that the same code can be compiled on any platform.
+*
+* Comparisons return an integer bit mask with one bit per lane, which can be combined using the
+* usual bit-wise operators.
+*
+*
+* This file is part of the implimentation and is not intended for public
+* use.
+*
+*
+* Forms part of the DxPRT project
+*
+*
+*
+* Author: Shaun Bailey
+*
+* Date created: 16/10/2026
+*
+* Last Updated: 16/10/2026
+*
+*
+*
+* MIT License
+*
+* Copyright (c) 2021 Shaun Bailey
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*
+*/
+
+#pragma once
+
+#include "DxPRT/Platform.h"
+
+#if defined(__AVX512F__)
+#define DXPRT_SIMD_AVX512
+#include <immintrin.h>
+#elif defined(__AVX2__)
+#define DXPRT_SIMD_AVX2
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define DXPRT_SIMD_SSE
+#include <emmintrin.h>
+#endif
+
+
+namespace DxPRT_Utility {
+
+#if defined(DXPRT_SIMD_AVX512)
+
+	static const UINT32 SIMD_WIDTH = 16;
+
+	struct SIMDFloat
+	{
+		__m512 v;
+	};
+
+	inline SIMDFloat SIMDLoad(const float* p) { return { _mm512_loadu_ps(p) }; }
+	inline SIMDFloat SIMDSet(const float& x) { return { _mm512_set1_ps(x) }; }
+	inline void SIMDStore(float* p, const SIMDFloat& a) { _mm512_storeu_ps(p, a.v); }
+	inline SIMDFloat operator+(const SIMDFloat& a, const SIMDFloat& b) { return { _mm512_add_ps(a.v, b.v) }; }
+	inline SIMDFloat operator-(const SIMDFloat& a, const SIMDFloat& b) { return { _mm512_sub_ps(a.v, b.v) }; }
+	inline SIMDFloat operator*(const SIMDFloat& a, const SIMDFloat& b) { return { _mm512_mul_ps(a.v, b.v) }; }
+	inline SIMDFloat operator/(const SIMDFloat& a, const SIMDFloat& b) { return { _mm512_div_ps(a.v, b.v) }; }
+	inline SIMDFloat SIMDMin(const SIMDFloat& a, const SIMDFloat& b) { return { _mm512_min_ps(a.v, b.v) }; }
+	inline SIMDFloat SIMDMax(const SIMDFloat& a, const SIMDFloat& b) { return { _mm512_max_ps(a.v, b.v) }; }
+	inline UINT32 SIMDLess(const SIMDFloat& a, const SIMDFloat& b) { return _mm512_cmp_ps_mask(a.v, b.v, _CMP_LT_OQ); }
+	inline UINT32 SIMDLessEqual(const SIMDFloat& a, const SIMDFloat& b) { return _mm512_cmp_ps_mask(a.v, b.v, _CMP_LE_OQ); }
+
+#elif defined(DXPRT_SIMD_AVX2)
+
+	static const UINT32 SIMD_WIDTH = 8;
+
+	struct SIMDFloat
+	{
+		__m256 v;
+	};
+
+	inline SIMDFloat SIMDLoad(const float* p) { return { _mm256_loadu_ps(p) }; }
+	inline SIMDFloat SIMDSet(const float& x) { return { _mm256_set1_ps(x) }; }
+	inline void SIMDStore(float* p, const SIMDFloat& a) { _mm256_storeu_ps(p, a.v); }
+	inline SIMDFloat operator+(const SIMDFloat& a, const SIMDFloat& b) { return { _mm256_add_ps(a.v, b.v) }; }
+	inline SIMDFloat operator-(const SIMDFloat& a, const SIMDFloat& b) { return { _mm256_sub_ps(a.v, b.v) }; }
+	inline SIMDFloat operator*(const SIMDFloat& a, const SIMDFloat& b) { return { _mm256_mul_ps(a.v, b.v) }; }
+	inline SIMDFloat operator/(const SIMDFloat& a, const SIMDFloat& b) { return { _mm256_div_ps(a.v, b.v) }; }
+	inline SIMDFloat SIMDMin(const SIMDFloat& a, const SIMDFloat& b) { return { _mm256_min_ps(a.v, b.v) }; }
+	inline SIMDFloat SIMDMax(const SIMDFloat& a, const SIMDFloat& b) { return { _mm256_max_ps(a.v, b.v) }; }
+	inline UINT32 SIMDLess(const SIMDFloat& a, const SIMDFloat& b) { return (UINT32)_mm256_movemask_ps(_mm256_cmp_ps(a.v, b.v, _CMP_LT_OQ)); }
+	inline UINT32 SIMDLessEqual(const SIMDFloat& a, const SIMDFloat& b) { return (UINT32)_mm256_movemask_ps(_mm256_cmp_ps(a.v, b.v, _CMP_LE_OQ)); }
+
+#elif defined(DXPRT_SIMD_SSE)
+
+	static const UINT32 SIMD_WIDTH = 4;
+
+	struct SIMDFloat
+	{
+		__m128 v;
+	};
+
+	inline SIMDFloat SIMDLoad(const float* p) { return { _mm_loadu_ps(p) }; }
+	inline SIMDFloat SIMDSet(const float& x) { return { _mm_set1_ps(x) }; }
+	inline void SIMDStore(float* p, const SIMDFloat& a) { _mm_storeu_ps(p, a.v); }
+	inline SIMDFloat operator+(const SIMDFloat& a, const SIMDFloat& b) { return { _mm_add_ps(a.v, b.v) }; }
+	inline SIMDFloat operator-(const SIMDFloat& a, const SIMDFloat& b) { return { _mm_sub_ps(a.v, b.v) }; }
+	inline SIMDFloat operator*(const SIMDFloat& a, const SIMDFloat& b) { return { _mm_mul_ps(a.v, b.v) }; }
+	inline SIMDFloat operator/(const SIMDFloat& a, const SIMDFloat& b) { return { _mm_div_ps(a.v, b.v) }; }
+	inline SIMDFloat SIMDMin(const SIMDFloat& a, const SIMDFloat& b) { return { _mm_min_ps(a.v, b.v) }; }
+	inline SIMDFloat SIMDMax(const SIMDFloat& a, const SIMDFloat& b) { return { _mm_max_ps(a.v, b.v) }; }
+	inline UINT32 SIMDLess(const SIMDFloat& a, const SIMDFloat& b) { return (UINT32)_mm_movemask_ps(_mm_cmplt_ps(a.v, b.v)); }
+	inline UINT32 SIMDLessEqual(const SIMDFloat& a, const SIMDFloat& b) { return (UINT32)_mm_movemask_ps(_mm_cmple_ps(a.v, b.v)); }
+
+#else
+
+	static const UINT32 SIMD_WIDTH = 4;
+
+	struct SIMDFloat
+	{
+		float v[4];
+	};
+
+	inline SIMDFloat SIMDLoad(const float* p) { return { { p[0], p[1], p[2], p[3] } }; }
+	inline SIMDFloat SIMDSet(const float& x) { return { { x, x, x, x } }; }
+	inline void SIMDStore(float* p, const SIMDFloat& a) { for (int i = 0; i < 4; ++i) p[i] = a.v[i]; }
+	inline SIMDFloat operator+(const SIMDFloat& a, const SIMDFloat& b) { return { { a.v[0] + b.v[0], a.v[1] + b.v[1], a.v[2] + b.v[2], a.v[3] + b.v[3] } }; }
+	inline SIMDFloat operator-(const SIMDFloat& a, const SIMDFloat& b) { return { { a.v[0] - b.v[0], a.v[1] - b.v[1], a.v[2] - b.v[2], a.v[3] - b.v[3] } }; }
+	inline SIMDFloat operator*(const SIMDFloat& a, const SIMDFloat& b) { return { { a.v[0] * b.v[0], a.v[1] * b.v[1], a.v[2] * b.v[2], a.v[3] * b.v[3] } }; }
+	inline SIMDFloat operator/(const SIMDFloat& a, const SIMDFloat& b) { return { { a.v[0] / b.v[0], a.v[1] / b.v[1], a.v[2] / b.v[2], a.v[3] / b.v[3] } }; }
+	// as with the SSE instructions, the second argument is returned if either is NaN
+	inline SIMDFloat SIMDMin(const SIMDFloat& a, const SIMDFloat& b) { SIMDFloat r; for (int i = 0; i < 4; ++i) r.v[i] = a.v[i] < b.v[i] ? a.v[i] : b.v[i]; return r; }
+	inline SIMDFloat SIMDMax(const SIMDFloat& a, const SIMDFloat& b) { SIMDFloat r; for (int i = 0; i < 4; ++i) r.v[i] = a.v[i] > b.v[i] ? a.v[i] : b.v[i]; return r; }
+	inline UINT32 SIMDLess(const SIMDFloat& a, const SIMDFloat& b) { UINT32 m = 0; for (int i = 0; i < 4; ++i) m |= (a.v[i] < b.v[i] ? 1u : 0u) << i; return m; }
+	inline UINT32 SIMDLessEqual(const SIMDFloat& a, const SIMDFloat& b) { UINT32 m = 0; for (int i = 0; i < 4; ++i) m |= (a.v[i] <= b.v[i] ? 1u : 0u) << i; return m; }
+
+#endif
+
+	// a mask with the first n lanes set
+	inline UINT32 SIMDLaneMask(const UINT32& n) { return n >= 32 ? 0xffffffffu : (1u << n) - 1u; }
+
+
+	// 8 floats, independent of SIMD_WIDTH. Used where the data has a natural width of 8, such as the
+	// children of a node of the 8-wide BVH (see BVH8.h). AVX2 is used if available, otherwise SSE or
+	// scalar code. Comparisons return a bit mask of the 8 lanes
+
+#if defined(__AVX2__)
+
+	struct SIMDFloat8
+	{
+		__m256 v;
+	};
+
+	inline SIMDFloat8 SIMD8Load(const float* p) { return { _mm256_loadu_ps(p) }; }
+	inline SIMDFloat8 SIMD8LoadBytes(const UINT8* p) { return { _mm256_cvtepi32_ps(_mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*)p))) }; }
+	inline SIMDFloat8 SIMD8Set(const float& x) { return { _mm256_set1_ps(x) }; }
+	inline void SIMD8Store(float* p, const SIMDFloat8& a) { _mm256_storeu_ps(p, a.v); }
+	inline SIMDFloat8 operator+(const SIMDFloat8& a, const SIMDFloat8& b) { return { _mm256_add_ps(a.v, b.v) }; }
+	inline SIMDFloat8 operator-(const SIMDFloat8& a, const SIMDFloat8& b) { return { _mm256_sub_ps(a.v, b.v) }; }
+	inline SIMDFloat8 operator*(const SIMDFloat8& a, const SIMDFloat8& b) { return { _mm256_mul_ps(a.v, b.v) }; }
+	inline SIMDFloat8 SIMD8Min(const SIMDFloat8& a, const SIMDFloat8& b) { return { _mm256_min_ps(a.v, b.v) }; }
+	inline SIMDFloat8 SIMD8Max(const SIMDFloat8& a, const SIMDFloat8& b) { return { _mm256_max_ps(a.v, b.v) }; }
+	inline UINT32 SIMD8Less(const SIMDFloat8& a, const SIMDFloat8& b) { return (UINT32)_mm256_movemask_ps(_mm256_cmp_ps(a.v, b.v, _CMP_LT_OQ)); }
+	inline UINT32 SIMD8LessEqual(const SIMDFloat8& a, const SIMDFloat8& b) { return (UINT32)_mm256_movemask_ps(_mm256_cmp_ps(a.v, b.v, _CMP_LE_OQ)); }
+
+#elif defined(DXPRT_SIMD_SSE)
+
+	struct SIMDFloat8
+	{
+		__m128 v[2];
+	};
+
+	inline SIMDFloat8 SIMD8Load(const float* p) { return { { _mm_loadu_ps(p), _mm_loadu_ps(p + 4) } }; }
+	inline SIMDFloat8 SIMD8LoadBytes(const UINT8* p)
+	{
+		__m128i zero = _mm_setzero_si128();
+		__m128i words = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i*)p), zero);
+		return { { _mm_cvtepi32_ps(_mm_unpacklo_epi16(words, zero)), _mm_cvtepi32_ps(_mm_unpackhi_epi16(words, zero)) } };
+	}
+	inline SIMDFloat8 SIMD8Set(const float& x) { return { { _mm_set1_ps(x), _mm_set1_ps(x) } }; }
+	inline void SIMD8Store(float* p, const SIMDFloat8& a) { _mm_storeu_ps(p, a.v[0]); _mm_storeu_ps(p + 4, a.v[1]); }
+	inline SIMDFloat8 operator+(const SIMDFloat8& a, const SIMDFloat8& b) { return { { _mm_add_ps(a.v[0], b.v[0]), _mm_add_ps(a.v[1], b.v[1]) } }; }
+	inline SIMDFloat8 operator-(const SIMDFloat8& a, const SIMDFloat8& b) { return { { _mm_sub_ps(a.v[0], b.v[0]), _mm_sub_ps(a.v[1], b.v[1]) } }; }
+	inline SIMDFloat8 operator*(const SIMDFloat8& a, const SIMDFloat8& b) { return { { _mm_mul_ps(a.v[0], b.v[0]), _mm_mul_ps(a.v[1], b.v[1]) } }; }
+	inline SIMDFloat8 SIMD8Min(const SIMDFloat8& a, const SIMDFloat8& b) { return { { _mm_min_ps(a.v[0], b.v[0]), _mm_min_ps(a.v[1], b.v[1]) } }; }
+	inline SIMDFloat8 SIMD8Max(const SIMDFloat8& a, const SIMDFloat8& b) { return { { _mm_max_ps(a.v[0], b.v[0]), _mm_max_ps(a.v[1], b.v[1]) } }; }
+	inline UINT32 SIMD8Less(const SIMDFloat8& a, const SIMDFloat8& b) { return (UINT32)(_mm_movemask_ps(_mm_cmplt_ps(a.v[0], b.v[0])) | (_mm_movemask_ps(_mm_cmplt_ps(a.v[1], b.v[1])) << 4)); }
+	inline UINT32 SIMD8LessEqual(const SIMDFloat8& a, const SIMDFloat8& b) { return (UINT32)(_mm_movemask_ps(_mm_cmple_ps(a.v[0], b.v[0])) | (_mm_movemask_ps(_mm_cmple_ps(a.v[1], b.v[1])) << 4)); }
+
+#else
+
+	struct SIMDFloat8
+	{
+		float v[8];
+	};
+
+	inline SIMDFloat8 SIMD8Load(const float* p) { SIMDFloat8 r; for (int i = 0; i < 8; ++i) r.v[i] = p[i]; return r; }
+	inline SIMDFloat8 SIMD8LoadBytes(const UINT8* p) { SIMDFloat8 r; for (int i = 0; i < 8; ++i) r.v[i] = float(p[i]); return r; }
+	inline SIMDFloat8 SIMD8Set(const float& x) { SIMDFloat8 r; for (int i = 0; i < 8; ++i) r.v[i] = x; return r; }
+	inline void SIMD8Store(float* p, const SIMDFloat8& a) { for (int i = 0; i < 8; ++i) p[i] = a.v[i]; }
+	inline SIMDFloat8 operator+(const SIMDFloat8& a, const SIMDFloat8& b) { SIMDFloat8 r; for (int i = 0; i < 8; ++i) r.v[i] = a.v[i] + b.v[i]; return r; }
+	inline SIMDFloat8 operator-(const SIMDFloat8& a, const SIMDFloat8& b) { SIMDFloat8 r; for (int i = 0; i < 8; ++i) r.v[i] = a.v[i] - b.v[i]; return r; }
+	inline SIMDFloat8 operator*(const SIMDFloat8& a, const SIMDFloat8& b) { SIMDFloat8 r; for (int i = 0; i < 8; ++i) r.v[i] = a.v[i] * b.v[i]; return r; }
+	// as with the SSE instructions, the second argument is returned if either is NaN
+	inline SIMDFloat8 SIMD8Min(const SIMDFloat8& a, const SIMDFloat8& b) { SIMDFloat8 r; for (int i = 0; i < 8; ++i) r.v[i] = a.v[i] < b.v[i] ? a.v[i] : b.v[i]; return r; }
+	inline SIMDFloat8 SIMD8Max(const SIMDFloat8& a, const SIMDFloat8& b) { SIMDFloat8 r; for (int i = 0; i < 8; ++i) r.v[i] = a.v[i] > b.v[i] ? a.v[i] : b.v[i]; return r; }
+	inline UINT32 SIMD8Less(const SIMDFloat8& a, const SIMDFloat8& b) { UINT32 m = 0; for (int i = 0; i < 8; ++i) m |= (a.v[i] < b.v[i] ? 1u : 0u) << i; return m; }
+	inline UINT32 SIMD8LessEqual(const SIMDFloat8& a, const SIMDFloat8& b) { UINT32 m = 0; for (int i = 0; i < 8; ++i) m |= (a.v[i] <= b.v[i] ? 1u : 0u) << i; return m; }
+
+#endif
+
+}
@@ -0,0 +1,174 @@
+/*
+*
+* Generation of the random numbers used in the Monte Carlo integration on the CPU. Either
+* pseudo-random numbers or a quasi-Monte Carlo (low discrepancy) sequence can be selected, see
+* SAMPLING_MODE in GenerateDesc.h. Both quasi-Monte Carlo sequences are randomized, with a different
+* randomization used for each integral (for example each vertex), such that the estimates remain
+* unbiased and the errors of neighbouring vertices are uncorrelated.
+*
+* The pseudo-random numbers come from the counter-based Philox4x32-10 generator (Salmon et al. 2011),
+* which has no state: the numbers of each event are a function of the seed, the stream (for example
+* the vertex) and the index of the event alone. The results are therefore reproducible for a given
+* seed, independent of the number of threads and the order in which the work is done.
+*
+*
+* This file is part of the implimentation and is not intended for public
+* use.
+*
+*
+* Forms part of the DxPRT project
+*
+*
+*
+* Author: Shaun Bailey
+*
+* Date created: 16/10/2026
+*
+* Last Updated: 16/10/2026
+*
+*
+*
+* MIT License
+*
+* Copyright (c) 2021 Shaun Bailey
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*
+*/
+
+#pragma once
+#include "DxPRT/Platform.h"
+#include "DxPRT/GenerateDesc.h"
+
+namespace DxPRT_Utility {
+
+    // the randomization applied to a quasi-Monte Carlo sequence
+    struct SampleScramble {
+        UINT32 seed[2]; // seeds of the Owen scrambling of each dimension of the Sobol sequence
+        float shift[2]; // Cranley-Patterson rotation of each dimension of the lattice
+    };
+
+
+    // identifies an independent stream of pseudo-random numbers, such as those of a single vertex
+    struct RandomStream {
+        UINT32 key[2]; // the seed
+        UINT32 stream;
+    };
+
+
+    /*
+    * InitializeRandomStream: creates the stream of pseudo-random numbers for a seed and stream index
+    *
+    * _IN_ seed: the seed of the whole integration (see PRT_DESC and EM_DESC)
+    * _IN_ stream: the index of the stream, for example the index of the vertex
+    */
+    RandomStream InitializeRandomStream(const UINT64& seed, const UINT64& stream);
+
+
+    /*
+    * Philox: the Philox4x32-10 counter-based generator, returns 4 random integers from a counter
+    * and key
+    *
+    * _IN_ counter: the 4 integers of the counter
+    * _IN_ key: the 2 integers of the key
+    * _OUT_ result: the 4 random integers
+    */
+    void Philox(const UINT32* counter, const UINT32* key, UINT32* result);
+
+
+    /*
+    * RandomIntegers: returns the 4 random integers of the event with the given index in a stream
+    *
+    * _IN_ stream: the stream of random numbers
+    * _IN_ index: the index of the event
+    * _OUT_ result: the 4 random integers
+    */
+    void RandomIntegers(const RandomStream& stream, const UINT64& index, UINT32* result);
+
+
+    /*
+    * RandomNumbers: same as RandomIntegers but returns two random numbers in [0, 1)
+    *
+    * _IN_ stream: the stream of random numbers
+    * _IN_ index: the index of the event
+    * _OUT_ random1: the first random number
+    * _OUT_ random2: the second random number
+    */
+    void RandomNumbers(const RandomStream& stream, const UINT64& index, float& random1, float& random2);
+
+
+    /*
+    * InitializeScramble: draws the randomization of a quasi-Monte Carlo sequence for a stream, this
+    * is independent of the random numbers of every event of the stream
+    *
+    * _IN_ stream: the stream of random numbers
+    */
+    SampleScramble InitializeScramble(const RandomStream& stream);
+
+
+    /*
+    * SobolSample: returns a point of the first two dimensions of the Sobol sequence, with nested
+    * uniform (Owen) scrambling implemented by hashing as described by Burley (2020)
+    *
+    * _IN_ index: the index of the point in the sequence
+    * _IN_ scramble: the randomization of the sequence
+    * _OUT_ random1: the first dimension, in [0, 1)
+    * _OUT_ random2: the second dimension, in [0, 1)
+    */
+    void SobolSample(const UINT32& index, const SampleScramble& scramble, float& random1, float& random2);
+
+
+    /*
+    * LatticeSample: returns a point of a rank-1 lattice of count points, with a Cranley-Patterson
+    * rotation. The generating vector is (1, g), where g is the integer coprime with count closest
+    * to count divided by the golden ratio (a generalisation of the Fibonacci lattice)
+    *
+    * _IN_ index: the index of the point, in [0, count)
+    * _IN_ count: the total number of points in the lattice
+    * _IN_ generator: the value of g (see LatticeGenerator)
+    * _IN_ scramble: the randomization of the lattice
+    * _OUT_ random1: the first dimension, in [0, 1)
+    * _OUT_ random2: the second dimension, in [0, 1)
+    */
+    void LatticeSample(const UINT64& index, const UINT64& count, const UINT64& generator,
+        const SampleScramble& scramble, float& random1, float& random2);
+
+
+    // returns the second component of the generating vector of a lattice of count points
+    UINT64 LatticeGenerator(const UINT64& count);
+
+
+    /*
+    * DrawSample: returns the two random numbers of a single Monte Carlo event using the selected
+    * sampling mode
+    *
+    * _IN_ mode: the sampling mode
+    * _IN_ index: the index of the event
+    * _IN_ count: the total number of events
+    * _IN_ generator: the lattice generator (see LatticeGenerator), only used by SAMPLING_LATTICE
+    * _IN_ scramble: the randomization of the sequence, not used by SAMPLING_PSEUDO_RANDOM
+    * _IN_ stream: the stream of pseudo-random numbers, only used by SAMPLING_PSEUDO_RANDOM
+    * _OUT_ random1: the first random number
+    * _OUT_ random2: the second random number
+    */
+    void DrawSample(const DxPRT::SAMPLING_MODE& mode, const UINT64& index, const UINT64& count,
+        const UINT64& generator, const SampleScramble& scramble, const RandomStream& stream,
+        float& random1, float& random2);
+
+}
@@ -67,6 +67,68 @@ namespace DxPRT_Utility {
 		, const float& phi);
 
 
+	/*
+	* CalcSH: calculates the spherical harmonics evaluated at a particular theta and phi
+	* without allocating memory (see CalcSHDirection)
+	*
+	* _IN_ N: the maximum value of l to be calculated
+	* _IN_ ctheta: the value of cos(theta) where the SHs shall be evaluated
+	* _IN_ phi: the value of phi where the SHs will be evaluated
+	* _OUT_ result: (N + 1)^2 floats containing the spherical harmonics
+	*/
+	void CalcSH(const size_t& N, const float& ctheta, const float& phi, float* result);
+
+
+	/*
+	* CalcSHDirection: calculates the spherical harmonics of a single direction, given by its
+	* Cartesian components (see CalcSHDirections). For N up to SH_EVAL_MAX_L, this dispatches
+	* to the evaluator specialized for N (see SHEval.h), otherwise the general recurrences are used
+	*
+	* _IN_ N: the maximum value of l to be calculated
+	* _IN_ x: the x component of the (normalized) direction
+	* _IN_ y: the y component of the direction
+	* _IN_ z: the z component of the direction
+	* _OUT_ result: (N + 1)^2 floats containing the spherical harmonics
+	*/
+	void CalcSHDirection(const size_t& N, const float& x, const float& y, const float& z,
+		float* result);
+
+
+	/*
+	* CalcSHDirections: calculates the spherical harmonics for a batch of directions, with the
+	* result stored as a structure of arrays. Rather than theta and phi, each direction is given by
+	* its Cartesian components, with theta measured from the y-axis and phi = atan2(z, x) + pi as in
+	* the shaders. For N up to SH_EVAL_MAX_L, SIMD_WIDTH directions are evaluated at once by the
+	* specialized evaluators (see SHEval.h). Otherwise the recurrences of CalcSH are used, with the
+	* factors of sin(theta)^m cos(m phi) and sin(theta)^m sin(m phi) found as polynomials in x and z
+	*
+	* _IN_ N: the maximum value of l to be calculated
+	* _IN_ count: the number of directions
+	* _IN_ x: the x component of each (normalized) direction
+	* _IN_ y: the y component of each direction
+	* _IN_ z: the z component of each direction
+	* _OUT_ result: (N + 1)^2 * count floats owned by the caller, the value of spherical harmonic k
+	* for direction i is stored at result[k * count + i]
+	*/
+	void CalcSHDirections(const size_t& N, const size_t& count, const float* x, const float* y,
+		const float* z, float* result);
+
+
+	/*
+	* CalcSHAngles: calculates the spherical harmonics for a batch of directions given by theta and
+	* phi, as in CalcSH. The result has the same layout as CalcSHDirections
+	*
+	* _IN_ N: the maximum value of l to be calculated
+	* _IN_ count: the number of directions
+	* _IN_ ctheta: the value of cos(theta) of each direction
+	* _IN_ phi: the value of phi of each direction
+	* _OUT_ result: (N + 1)^2 * count floats owned by the caller, the value of spherical harmonic k
+	* for direction i is stored at result[k * count + i]
+	*/
+	void CalcSHAngles(const size_t& N, const size_t& count, const float* ctheta, const float* phi,
+		float* result);
+
+
 	/*
 	* CalcLegendre1: calculates the Legendre function when m = l
 	* 
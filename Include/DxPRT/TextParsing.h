@@ -0,0 +1,153 @@
+/*
+*
+* Functions to tokenize the text files read by DxPRT (.obj and .prt). The files are scanned in
+* place and numbers converted with std::from_chars, such that no strings are allocated.
+*
+*
+* This file is part of the implimentation and is not intended for public
+* use.
+*
+*
+* Forms part of the DxPRT project
+*
+*
+*
+* Author: Shaun Bailey
+*
+* Date created: 16/10/2026
+*
+* Last Updated: 16/10/2026
+*
+*
+*
+* MIT License
+*
+* Copyright (c) 2021 Shaun Bailey
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*
+*/
+
+#pragma once
+
+#include "DxPRT/Platform.h"
+#include <charconv>
+#include <cstddef>
+#include <vector>
+
+
+namespace DxPRT_Utility {
+
+	// large files are split into chunks of around this many bytes, which are parsed in parallel
+	static const size_t TEXT_CHUNK_SIZE = 1 << 20;
+
+	// the most characters written by FormatTextValue for any float, double or integer
+	static const size_t TEXT_VALUE_MAX_SIZE = 32;
+
+	// returns the end of the line starting at p, excluding the new line character
+	const char* FindLineEnd(const char* p, const char* end);
+
+	// returns the start of the line after the one ending at lineEnd
+	const char* NextLine(const char* lineEnd, const char* end);
+
+	// returns true for the characters that separate the values of a line
+	inline bool IsTextSpace(const char& c)
+	{
+		return c == ' ' || c == '\t' || c == '\r';
+	}
+
+	// returns the first character of the line after p that is not a space
+	const char* SkipTextSpaces(const char* p, const char* lineEnd);
+
+	// returns true if only spaces remain in the line
+	bool IsTextLineEnd(const char* p, const char* lineEnd);
+
+	// returns the end of the token (e.g. a specifier) starting at p
+	const char* FindTokenEnd(const char* p, const char* lineEnd);
+
+
+	/*
+	* SplitTextLines: splits the text into ranges of whole lines of around equal size, some of which
+	* may be empty. Returns the bounds of the ranges, where range i is [bounds[i], bounds[i + 1])
+	*
+	* _IN_ data: the start of the text
+	* _IN_ size: the size of the text in bytes
+	* _IN_ numThreads: the number of threads that will parse the ranges, each receives around 4
+	*/
+	std::vector<const char*> SplitTextLines(const char* data, const size_t& size,
+		const UINT64& numThreads);
+
+
+	/*
+	* ParseTextValue: parses a single number starting at p. Returns a pointer to the character
+	* after the number, or nullptr if p is not the start of a number
+	*
+	* _IN_ p: the start of the number
+	* _IN_ lineEnd: the end of the line
+	* _OUT_ value: the parsed number
+	*/
+	template<typename T>
+	const char* ParseTextValue(const char* p, const char* lineEnd, T& value)
+	{
+		if (p != lineEnd && *p == '+') ++p; // accepted by stof and stoi but not from_chars
+
+		std::from_chars_result result = std::from_chars(p, lineEnd, value);
+		if (result.ec != std::errc()) return nullptr;
+		return result.ptr;
+	}
+
+
+	/*
+	* ParseTextValues: parses count numbers, each of which must be preceded by at least one space.
+	* Returns a pointer to the character after the last number, or nullptr if there are too few
+	* numbers or one cannot be parsed
+	*
+	* _IN_ p: the start of the spaces before the first number
+	* _IN_ lineEnd: the end of the line
+	* _OUT_ values: array of at least count numbers
+	* _IN_ count: the number of values to parse
+	*/
+	template<typename T>
+	const char* ParseTextValues(const char* p, const char* lineEnd, T* values, const size_t& count)
+	{
+		for (size_t i = 0; i < count; ++i)
+		{
+			if (p == lineEnd || !IsTextSpace(*p)) return nullptr;
+			p = ParseTextValue(SkipTextSpaces(p, lineEnd), lineEnd, values[i]);
+			if (!p) return nullptr;
+		}
+		return p;
+	}
+
+
+
+	/*
+	* FormatTextValue: writes a number using the shortest form that is read back as exactly the
+	* same value by ParseTextValue. Returns a pointer to the character after the number
+	*
+	* _IN_ p: the start of a buffer with space for at least TEXT_VALUE_MAX_SIZE characters
+	* _IN_ value: the number to write
+	*/
+	template<typename T>
+	char* FormatTextValue(char* p, const T& value)
+	{
+		return std::to_chars(p, p + TEXT_VALUE_MAX_SIZE, value).ptr;
+	}
+
+}
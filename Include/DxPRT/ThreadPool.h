@@ -0,0 +1,148 @@
+/*
+*
+* The ThreadPool class, a pool of persistent worker threads used by the CPU implementation. Work
+* is submitted as a range of indices which is split into smaller ranges and shared evenly between
+* a queue for each thread. Each thread works through its own queue from the front, and once it is
+* empty steals ranges from the back of the queues of the other threads, such that the load stays
+* balanced even when the cost of each index varies.
+*
+* The thread that calls ParallelFor also takes part in the work, such that a pool of N threads
+* creates N - 1 worker threads.
+*
+*
+* This file is part of the implimentation and is not intended for public
+* use.
+*
+*
+* Forms part of the DxPRT project
+*
+*
+*
+* Author: Shaun Bailey
+*
+* Date created: 16/10/2026
+*
+* Last Updated: 16/10/2026
+*
+*
+*
+* MIT License
+*
+* Copyright (c) 2021 Shaun Bailey
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*
+*/
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "DxPRT/Platform.h"
+
+
+namespace DxPRT_Utility {
+
+	class ThreadPool
+	{
+	public:
+
+		// default constructor, the pool contains a single thread (the calling thread)
+		ThreadPool();
+
+		// constructor that automatically calls the Initialize function
+		ThreadPool(const UINT64& numThreads);
+
+		// joins all of the worker threads
+		~ThreadPool();
+
+		ThreadPool(const ThreadPool&) = delete;
+		ThreadPool& operator=(const ThreadPool&) = delete;
+
+		/*
+		* Initialize: starts the worker threads, any existing workers are first joined
+		*
+		* _IN_ numThreads: the total number of threads including the calling thread, if
+		* 0 then every hardware thread is used
+		*/
+		void Initialize(const UINT64& numThreads);
+
+		/*
+		* ParallelFor: calls func over the range [0, count) split into ranges of at most grainSize
+		* indices, returning once every range has been processed. If func throws an exception, the
+		* remaining ranges are still processed and the first exception is rethrown
+		*
+		* _IN_ count: the number of indices in the range
+		* _IN_ grainSize: the maximum number of indices passed to a single call of func, if 0 then
+		* this is chosen such that each thread receives around 16 ranges
+		* _IN_ func: called as func(iThread, begin, end), where iThread is in [0, GetNumThreads())
+		* and may be used to index per-thread data
+		*/
+		void ParallelFor(const UINT64& count, const UINT64& grainSize,
+			const std::function<void(UINT64, UINT64, UINT64)>& func);
+
+		// returns the total number of threads, including the calling thread
+		UINT64 GetNumThreads() const;
+
+	private:
+
+		// the queue of ranges of a single thread
+		struct WorkQueue
+		{
+			std::mutex mutex;
+			std::deque<std::pair<UINT64, UINT64>> ranges;
+		};
+
+		// waits for and executes work until the pool is destroyed
+		void WorkerLoop(const UINT64& iThread);
+
+		// executes ranges from the queues until all are empty
+		void RunRanges(const UINT64& iThread);
+
+		// takes a range from the front of the threads own queue, or steals from the back of another
+		bool TakeRange(const UINT64& iThread, UINT64& begin, UINT64& end);
+
+		// joins the worker threads
+		void Shutdown();
+
+		UINT64 numThreads_ = 1;
+		std::vector<std::thread> workers_;
+		std::vector<std::unique_ptr<WorkQueue>> queues_;
+
+		std::mutex mutex_; // guards the members below
+		std::condition_variable workCondition_;
+		std::condition_variable doneCondition_;
+		const std::function<void(UINT64, UINT64, UINT64)>* job_ = nullptr;
+		UINT64 generation_ = 0;
+		UINT64 busyWorkers_ = 0;
+		bool stop_ = false;
+		std::exception_ptr exception_;
+
+		std::atomic<UINT64> pendingRanges_{ 0 };
+
+	};
+
+}
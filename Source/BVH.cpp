@@ -0,0 +1,1059 @@
+/*
+*
+* Implimentation of BVH.h
+*
+*
+* This file is part of the implimentation and is not intended for public
+* use.
+*
+*
+* Forms part of the DxPRT project
+*
+*
+*
+* Author: Shaun Bailey
+*
+* Date created: 16/10/2026
+*
+* Last Updated: 16/10/2026
+*
+*
+*
+* MIT License
+*
+* Copyright (c) 2021 Shaun Bailey
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*
+*/
+
+#include "DxPRT/BVH.h"
+#include "DxPRT/SIMD.h"
+#include "DxPRT/ThreadPool.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <functional>
+#include <limits>
+
+
+namespace DxPRT_Utility {
+
+	static const UINT32 NUM_BINS = 16; // number of bins used along each axis to find the split
+	static const UINT32 MAX_LEAF_SIZE = 8; // leaves larger than this are always split if possible
+	static const UINT32 MAX_DEPTH = 64; // also the size of the traversal stack
+	static const float TRAVERSAL_COST = 1.0f; // cost of visiting a node relative to testing a triangle
+	static const float INF = std::numeric_limits<float>::infinity();
+	static const UINT64 PARALLEL_BUILD_SIZE = 1 << 16; // meshes with fewer triangles are built on the calling thread
+	static const UINT64 PARALLEL_BIN_SIZE = 1 << 16; // nodes with more triangles than this are binned by every thread
+	static const UINT64 MIN_TASK_SIZE = 1 << 12; // the fewest triangles in a subtree built as a single task
+	static const UINT64 MORTON_TASK_SIZE = 1 << 14; // nodes with more triangles than this are split by their Morton codes
+
+
+	// half of the surface area of a box, the factor of two cancels in the SAH
+	static float HalfArea(const float* boundsMin, const float* boundsMax)
+	{
+		float extent[3];
+		for (int i = 0; i < 3; ++i)
+		{
+			extent[i] = boundsMax[i] - boundsMin[i];
+		}
+		return extent[0] * extent[1] + extent[1] * extent[2] + extent[2] * extent[0];
+	}
+
+
+	// bounds and number of triangles within a single bin
+	struct BVHBin
+	{
+		float boundsMin[3] = { INF, INF, INF };
+		float boundsMax[3] = { -INF, -INF, -INF };
+		UINT32 count = 0;
+
+		void Grow(const float* triangle)
+		{
+			for (int j = 0; j < 3; ++j)
+			{
+				for (int i = 0; i < 3; ++i)
+				{
+					boundsMin[i] = (std::min)(boundsMin[i], triangle[3 * j + i]);
+					boundsMax[i] = (std::max)(boundsMax[i], triangle[3 * j + i]);
+				}
+			}
+		}
+
+		void Grow(const BVHPrimitive& primitive)
+		{
+			for (int i = 0; i < 3; ++i)
+			{
+				boundsMin[i] = (std::min)(boundsMin[i], primitive.boundsMin[i]);
+				boundsMax[i] = (std::max)(boundsMax[i], primitive.boundsMax[i]);
+			}
+			++count;
+		}
+
+		void Grow(const BVHBin& bin)
+		{
+			for (int i = 0; i < 3; ++i)
+			{
+				boundsMin[i] = (std::min)(boundsMin[i], bin.boundsMin[i]);
+				boundsMax[i] = (std::max)(boundsMax[i], bin.boundsMax[i]);
+			}
+			count += bin.count;
+		}
+
+		float Area() const
+		{
+			return count == 0 ? 0.0f : HalfArea(boundsMin, boundsMax);
+		}
+	};
+
+
+	// the bins along each axis of a node
+	struct BVHBinSet
+	{
+		BVHBin bins[3][NUM_BINS];
+	};
+
+
+	// twice the centre of the bounds of a primitive along an axis, used to place it in the bins
+	static float Centroid(const BVHPrimitive& primitive, const int& axis)
+	{
+		return primitive.boundsMin[axis] + primitive.boundsMax[axis];
+	}
+
+
+	// spreads the lower 10 bits of x such that there are two zero bits between each
+	static UINT32 ExpandMortonBits(UINT32 x)
+	{
+		x &= 0x3ff;
+		x = (x | (x << 16)) & 0x030000ff;
+		x = (x | (x << 8)) & 0x0300f00f;
+		x = (x | (x << 4)) & 0x030c30c3;
+		x = (x | (x << 2)) & 0x09249249;
+		return x;
+	}
+
+
+	/*
+	* ReduceBounds: combines the bounds found by grow over the primitives of a node. If the node
+	* is large, then each thread calls grow over part of the primitives
+	*
+	* _IN_ node: the node
+	* _IN_ threadPool: the threads used, may be nullptr
+	* _IN_ grow: called as grow(first, end, bounds), grows bounds over a range of the primitives
+	*/
+	static BVHBin ReduceBounds(const BVHNode& node, ThreadPool* threadPool,
+		const std::function<void(const UINT32&, const UINT32&, BVHBin&)>& grow)
+	{
+		BVHBin bounds;
+		if (threadPool && node.count > PARALLEL_BIN_SIZE && threadPool->GetNumThreads() > 1)
+		{
+			std::vector<BVHBin> threadBounds(threadPool->GetNumThreads());
+			threadPool->ParallelFor(node.count, PARALLEL_BIN_SIZE / 4, [&](UINT64 iThread, UINT64 begin, UINT64 end) {
+				grow(node.leftFirst + (UINT32)begin, node.leftFirst + (UINT32)end, threadBounds[iThread]);
+			});
+			for (const BVHBin& threadBound : threadBounds) bounds.Grow(threadBound);
+		}
+		else
+		{
+			grow(node.leftFirst, node.leftFirst + node.count, bounds);
+		}
+		return bounds;
+	}
+
+
+	BVH::BVH() {}
+
+	BVH::BVH(const float* vertexData, const UINT64& vertexNum,
+		const UINT32* indexData, const UINT64& triangleNum, const BVHBuildSettings& settings)
+	{
+		this->Build(vertexData, vertexNum, indexData, triangleNum, settings);
+	}
+
+
+	void BVH::Build(const float* vertexData, const UINT64&,
+		const UINT32* indexData, const UINT64& triangleNum, const BVHBuildSettings& settings)
+	{
+		auto startTime = std::chrono::steady_clock::now();
+
+		nodes_.clear();
+		buildStats_ = BVHBuildStats();
+		isBuilt_ = false;
+
+		ThreadPool threadPool(triangleNum < PARALLEL_BUILD_SIZE ? 1 : settings.numThreads);
+
+		// copy the triangles and calculate their bounds
+		triangles_.resize(triangleNum * 9);
+		primitives_.resize(triangleNum);
+		threadPool.ParallelFor(triangleNum, 0, [&](UINT64, UINT64 begin, UINT64 end) {
+			for (UINT64 iTriangle = begin; iTriangle < end; ++iTriangle)
+			{
+				for (int j = 0; j < 3; ++j)
+				{
+					const float* vertex = vertexData + 3ull * indexData[3 * iTriangle + j];
+					for (int i = 0; i < 3; ++i)
+					{
+						triangles_[9 * iTriangle + 3 * j + i] = vertex[i];
+					}
+				}
+				BVHBin bounds;
+				bounds.Grow(&triangles_[9 * iTriangle]);
+				BVHPrimitive& primitive = primitives_[iTriangle];
+				std::copy(bounds.boundsMin, bounds.boundsMin + 3, primitive.boundsMin);
+				std::copy(bounds.boundsMax, bounds.boundsMax + 3, primitive.boundsMax);
+				primitive.index = (UINT32)iTriangle;
+			}
+		});
+
+		if (triangleNum == 0) return;
+
+		nodes_.reserve(2 * triangleNum - 1);
+		BVHNode root = {};
+		root.leftFirst = 0;
+		root.count = (UINT32)triangleNum;
+		nodes_.push_back(root);
+		this->UpdateBounds(nodes_[0], &threadPool);
+
+		std::vector<UINT32> mortonCodes;
+		if (settings.mortonPresort) this->SortMorton(mortonCodes, &threadPool);
+
+		// the top of the hierarchy is split here, with the work of each large node shared between the
+		// threads. Nodes with fewer than taskSize triangles are left to be split as independent tasks.
+		// The Morton splits use a fixed size, such that the tree does not depend on the number of threads
+		UINT64 taskSize = (std::max)(MIN_TASK_SIZE, triangleNum / (threadPool.GetNumThreads() * 8));
+		if (settings.mortonPresort) taskSize = MORTON_TASK_SIZE;
+
+		std::vector<std::pair<UINT32, UINT32>> tasks; // (node, depth)
+		std::vector<std::pair<UINT32, UINT32>> stack; // (node, depth)
+		stack.push_back({ 0, 0 });
+		while (!stack.empty())
+		{
+			auto current = stack.back();
+			stack.pop_back();
+			if (nodes_[current.first].count <= taskSize)
+			{
+				tasks.push_back(current);
+				continue;
+			}
+
+			bool isSplit = false;
+			if (settings.mortonPresort)
+			{
+				isSplit = this->SubdivideMorton(nodes_, current.first, mortonCodes, &threadPool);
+				if (!isSplit)
+				{
+					tasks.push_back(current); // all codes are the same, so the SAH is used instead
+					continue;
+				}
+			}
+			else
+			{
+				isSplit = this->Subdivide(nodes_, current.first, current.second, &threadPool);
+			}
+
+			if (isSplit)
+			{
+				UINT32 leftChild = nodes_[current.first].leftFirst;
+				stack.push_back({ leftChild + 1, current.second + 1 });
+				stack.push_back({ leftChild, current.second + 1 });
+			}
+		}
+
+		// each task builds its subtree into its own array, which are then appended to nodes_
+		std::vector<std::vector<BVHNode>> taskNodes(tasks.size());
+		threadPool.ParallelFor(tasks.size(), 1, [&](UINT64, UINT64 begin, UINT64 end) {
+			for (UINT64 iTask = begin; iTask < end; ++iTask)
+			{
+				std::vector<BVHNode>& subtree = taskNodes[iTask];
+				subtree.reserve(2ull * nodes_[tasks[iTask].first].count - 1);
+				subtree.push_back(nodes_[tasks[iTask].first]);
+
+				std::vector<std::pair<UINT32, UINT32>> taskStack;
+				taskStack.push_back({ 0, tasks[iTask].second });
+				while (!taskStack.empty())
+				{
+					auto current = taskStack.back();
+					taskStack.pop_back();
+					if (this->Subdivide(subtree, current.first, current.second, nullptr))
+					{
+						UINT32 leftChild = subtree[current.first].leftFirst;
+						taskStack.push_back({ leftChild + 1, current.second + 1 });
+						taskStack.push_back({ leftChild, current.second + 1 });
+					}
+				}
+			}
+		});
+
+		for (size_t iTask = 0; iTask < tasks.size(); ++iTask)
+		{
+			// node i > 0 of the subtree is moved to offset + i, while its root replaces the task node
+			std::vector<BVHNode>& subtree = taskNodes[iTask];
+			UINT32 offset = (UINT32)nodes_.size() - 1;
+			for (BVHNode& node : subtree)
+			{
+				if (node.count == 0) node.leftFirst += offset;
+			}
+			nodes_[tasks[iTask].first] = subtree[0];
+			nodes_.insert(nodes_.end(), subtree.begin() + 1, subtree.end());
+			std::vector<BVHNode>().swap(subtree);
+		}
+
+		// store the triangles in the order they are referenced by the leaves
+		std::vector<float> reordered(triangles_.size());
+		triangleIndices_.resize(triangleNum);
+		threadPool.ParallelFor(triangleNum, 0, [&](UINT64, UINT64 begin, UINT64 end) {
+			for (UINT64 i = begin; i < end; ++i)
+			{
+				UINT32 iTriangle = primitives_[i].index;
+				std::copy(triangles_.begin() + 9ull * iTriangle, triangles_.begin() + 9ull * iTriangle + 9,
+					reordered.begin() + 9 * i);
+				triangleIndices_[i] = iTriangle;
+			}
+		});
+		triangles_.swap(reordered);
+
+		primitives_.clear();
+		primitives_.shrink_to_fit();
+
+		isBuilt_ = true;
+
+		buildStats_.buildTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+		this->CalcBuildStats();
+	}
+
+
+	void BVH::SortMorton(std::vector<UINT32>& mortonCodes, ThreadPool* threadPool)
+	{
+		UINT64 triangleNum = primitives_.size();
+
+		// the centroids are quantized to 10 bits along each axis within their bounds
+		float centroidMin[3], centroidMax[3];
+		this->CentroidBounds(nodes_[0], centroidMin, centroidMax, threadPool);
+		float scale[3];
+		for (int i = 0; i < 3; ++i)
+		{
+			float extent = centroidMax[i] - centroidMin[i];
+			scale[i] = extent > 0.0f ? 1023.0f / extent : 0.0f;
+		}
+
+		// the key holds the code in the upper 32 bits and the primitive in the lower 32 bits
+		std::vector<UINT64> keys(triangleNum), sortedKeys(triangleNum);
+		threadPool->ParallelFor(triangleNum, 0, [&](UINT64, UINT64 begin, UINT64 end) {
+			for (UINT64 i = begin; i < end; ++i)
+			{
+				UINT32 code = 0;
+				for (int axis = 0; axis < 3; ++axis)
+				{
+					UINT32 x = (UINT32)((Centroid(primitives_[i], axis) - centroidMin[axis]) * scale[axis]);
+					code |= ExpandMortonBits((std::min)(x, 1023u)) << (2 - axis);
+				}
+				keys[i] = (UINT64(code) << 32) | i;
+			}
+		});
+
+		// least significant digit radix sort of the 30 bits of the codes, 10 bits at a time
+		for (int shift = 32; shift < 62; shift += 10)
+		{
+			std::vector<UINT64> offsets(1025, 0);
+			for (UINT64 key : keys) ++offsets[((key >> shift) & 0x3ff) + 1];
+			for (size_t i = 1; i < offsets.size(); ++i) offsets[i] += offsets[i - 1];
+			for (UINT64 key : keys) sortedKeys[offsets[(key >> shift) & 0x3ff]++] = key;
+			keys.swap(sortedKeys);
+		}
+
+		std::vector<BVHPrimitive> sortedPrimitives(triangleNum);
+		mortonCodes.resize(triangleNum);
+		threadPool->ParallelFor(triangleNum, 0, [&](UINT64, UINT64 begin, UINT64 end) {
+			for (UINT64 i = begin; i < end; ++i)
+			{
+				sortedPrimitives[i] = primitives_[(UINT32)keys[i]];
+				mortonCodes[i] = (UINT32)(keys[i] >> 32);
+			}
+		});
+		primitives_.swap(sortedPrimitives);
+	}
+
+
+	bool BVH::SubdivideMorton(std::vector<BVHNode>& nodes, const UINT32& iNode,
+		const std::vector<UINT32>& mortonCodes, ThreadPool* threadPool)
+	{
+		// the primitives of the node are sorted by their codes, which share all of the bits above
+		// the highest bit that differs between the first and last code. The node is split where
+		// this bit changes
+		UINT32 first = nodes[iNode].leftFirst, count = nodes[iNode].count;
+		UINT32 firstCode = mortonCodes[first], lastCode = mortonCodes[first + count - 1];
+		if (firstCode == lastCode) return false;
+
+		int bit = 31;
+		while (((firstCode ^ lastCode) >> bit) == 0) --bit;
+		auto begin = mortonCodes.begin() + first;
+		UINT32 leftCount = (UINT32)(std::partition_point(begin, begin + count,
+			[&](const UINT32& code) { return ((code >> bit) & 1) == 0; }) - begin);
+
+		UINT32 leftChild = (UINT32)nodes.size();
+		BVHNode child = {};
+		child.leftFirst = first;
+		child.count = leftCount;
+		nodes.push_back(child);
+		child.leftFirst = first + leftCount;
+		child.count = count - leftCount;
+		nodes.push_back(child);
+
+		nodes[iNode].leftFirst = leftChild;
+		nodes[iNode].count = 0;
+
+		this->UpdateBounds(nodes[leftChild], threadPool);
+		this->UpdateBounds(nodes[leftChild + 1], threadPool);
+
+		return true;
+	}
+
+
+	bool BVH::Subdivide(std::vector<BVHNode>& nodes, const UINT32& iNode, const UINT32& depth,
+		ThreadPool* threadPool)
+	{
+		BVHNode& node = nodes[iNode];
+		if (node.count <= 1 || depth + 1 >= MAX_DEPTH) return false;
+
+		// bounds of the centroids, used to place the bins
+		float centroidMin[3], centroidMax[3];
+		this->CentroidBounds(node, centroidMin, centroidMax, threadPool);
+
+		float scale[3];
+		for (int axis = 0; axis < 3; ++axis)
+		{
+			float extent = centroidMax[axis] - centroidMin[axis];
+			scale[axis] = extent > 0.0f ? float(NUM_BINS) / extent : 0.0f;
+		}
+
+		// the primitives are binned along every axis in a single pass
+		BVHBinSet binSet;
+		if (threadPool && node.count > PARALLEL_BIN_SIZE && threadPool->GetNumThreads() > 1)
+		{
+			std::vector<BVHBinSet> threadBinSets(threadPool->GetNumThreads());
+			threadPool->ParallelFor(node.count, PARALLEL_BIN_SIZE / 4, [&](UINT64 iThread, UINT64 begin, UINT64 end) {
+				this->BinPrimitives(node.leftFirst + (UINT32)begin, node.leftFirst + (UINT32)end, centroidMin,
+					scale, threadBinSets[iThread]);
+			});
+			for (const BVHBinSet& threadBinSet : threadBinSets)
+			{
+				for (int axis = 0; axis < 3; ++axis)
+				{
+					for (UINT32 i = 0; i < NUM_BINS; ++i) binSet.bins[axis][i].Grow(threadBinSet.bins[axis][i]);
+				}
+			}
+		}
+		else
+		{
+			this->BinPrimitives(node.leftFirst, node.leftFirst + node.count, centroidMin, scale, binSet);
+		}
+
+		// find the split plane with the lowest cost
+		float bestCost = INF;
+		int bestAxis = -1;
+		UINT32 bestSplit = 0;
+		BVHBin bestLeft, bestRight;
+		for (int axis = 0; axis < 3; ++axis)
+		{
+			if (scale[axis] == 0.0f) continue;
+			const BVHBin* bins = binSet.bins[axis];
+
+			// sweep from both sides to get the cost of each of the NUM_BINS - 1 planes
+			BVHBin left[NUM_BINS - 1], right[NUM_BINS - 1];
+			BVHBin leftBin, rightBin;
+			for (UINT32 i = 0; i < NUM_BINS - 1; ++i)
+			{
+				leftBin.Grow(bins[i]);
+				left[i] = leftBin;
+				rightBin.Grow(bins[NUM_BINS - 1 - i]);
+				right[NUM_BINS - 2 - i] = rightBin;
+			}
+
+			for (UINT32 i = 0; i < NUM_BINS - 1; ++i)
+			{
+				if (left[i].count == 0 || right[i].count == 0) continue;
+				float cost = left[i].count * left[i].Area() + right[i].count * right[i].Area();
+				if (cost < bestCost)
+				{
+					bestCost = cost;
+					bestAxis = axis;
+					bestSplit = i;
+					bestLeft = left[i];
+					bestRight = right[i];
+				}
+			}
+		}
+
+		if (bestAxis == -1) return false; // all centroids are the same
+
+		float nodeArea = HalfArea(node.boundsMin, node.boundsMax);
+		float splitCost = TRAVERSAL_COST * nodeArea + bestCost;
+		float leafCost = node.count * nodeArea;
+		if (splitCost >= leafCost && node.count <= MAX_LEAF_SIZE) return false;
+
+		// partition the primitives about the split plane
+		auto begin = primitives_.begin() + node.leftFirst;
+		auto middle = std::partition(begin, begin + node.count,
+			[&](const BVHPrimitive& primitive) {
+				UINT32 iBin = (std::min)(NUM_BINS - 1,
+					(UINT32)((Centroid(primitive, bestAxis) - centroidMin[bestAxis]) * scale[bestAxis]));
+				return iBin <= bestSplit;
+			});
+		UINT32 leftCount = (UINT32)(middle - begin);
+		if (leftCount == 0 || leftCount == node.count) return false;
+
+		// create the children, node may be invalidated by push_back. The bounds of each child are
+		// those of the bins on its side of the plane
+		UINT32 leftFirst = node.leftFirst, count = node.count;
+		UINT32 leftChild = (UINT32)nodes.size();
+
+		BVHNode child = {};
+		child.leftFirst = leftFirst;
+		child.count = leftCount;
+		std::copy(bestLeft.boundsMin, bestLeft.boundsMin + 3, child.boundsMin);
+		std::copy(bestLeft.boundsMax, bestLeft.boundsMax + 3, child.boundsMax);
+		nodes.push_back(child);
+		child.leftFirst = leftFirst + leftCount;
+		child.count = count - leftCount;
+		std::copy(bestRight.boundsMin, bestRight.boundsMin + 3, child.boundsMin);
+		std::copy(bestRight.boundsMax, bestRight.boundsMax + 3, child.boundsMax);
+		nodes.push_back(child);
+
+		nodes[iNode].leftFirst = leftChild;
+		nodes[iNode].count = 0;
+
+		return true;
+	}
+
+
+	void BVH::BinPrimitives(const UINT32& first, const UINT32& end, const float* centroidMin,
+		const float* scale, BVHBinSet& binSet) const
+	{
+		for (UINT32 i = first; i < end; ++i)
+		{
+			const BVHPrimitive& primitive = primitives_[i];
+			for (int axis = 0; axis < 3; ++axis)
+			{
+				if (scale[axis] == 0.0f) continue;
+				UINT32 iBin = (std::min)(NUM_BINS - 1,
+					(UINT32)((Centroid(primitive, axis) - centroidMin[axis]) * scale[axis]));
+				binSet.bins[axis][iBin].Grow(primitive);
+			}
+		}
+	}
+
+
+	void BVH::CentroidBounds(const BVHNode& node, float* centroidMin, float* centroidMax,
+		ThreadPool* threadPool) const
+	{
+		// the bounds are found with a bin, as the centroids are only points
+		BVHBin bounds = ReduceBounds(node, threadPool, [this](const UINT32& first, const UINT32& end, BVHBin& bin) {
+			for (UINT32 i = first; i < end; ++i)
+			{
+				for (int axis = 0; axis < 3; ++axis)
+				{
+					float centroid = Centroid(primitives_[i], axis);
+					bin.boundsMin[axis] = (std::min)(bin.boundsMin[axis], centroid);
+					bin.boundsMax[axis] = (std::max)(bin.boundsMax[axis], centroid);
+				}
+			}
+		});
+		std::copy(bounds.boundsMin, bounds.boundsMin + 3, centroidMin);
+		std::copy(bounds.boundsMax, bounds.boundsMax + 3, centroidMax);
+	}
+
+
+	void BVH::UpdateBounds(BVHNode& node, ThreadPool* threadPool) const
+	{
+		BVHBin bounds = ReduceBounds(node, threadPool, [this](const UINT32& first, const UINT32& end, BVHBin& bin) {
+			for (UINT32 i = first; i < end; ++i) bin.Grow(primitives_[i]);
+		});
+		std::copy(bounds.boundsMin, bounds.boundsMin + 3, node.boundsMin);
+		std::copy(bounds.boundsMax, bounds.boundsMax + 3, node.boundsMax);
+	}
+
+
+	void BVH::CalcBuildStats()
+	{
+		buildStats_.nodeNum = nodes_.size();
+		float rootArea = HalfArea(nodes_[0].boundsMin, nodes_[0].boundsMax);
+		double totalCost = 0.0, totalLeafDepth = 0.0;
+
+		std::vector<std::pair<UINT32, UINT32>> stack; // (node, depth)
+		stack.push_back({ 0, 0 });
+		while (!stack.empty())
+		{
+			auto current = stack.back();
+			stack.pop_back();
+			const BVHNode& node = nodes_[current.first];
+			float area = HalfArea(node.boundsMin, node.boundsMax);
+			buildStats_.maxDepth = (std::max)(buildStats_.maxDepth, current.second);
+
+			if (node.count > 0)
+			{
+				totalCost += double(node.count) * area;
+				totalLeafDepth += current.second;
+				++buildStats_.leafNum;
+				if (buildStats_.leafSizeHistogram.size() <= node.count) buildStats_.leafSizeHistogram.resize(node.count + 1, 0);
+				++buildStats_.leafSizeHistogram[node.count];
+			}
+			else
+			{
+				totalCost += double(TRAVERSAL_COST) * area;
+				stack.push_back({ node.leftFirst, current.second + 1 });
+				stack.push_back({ node.leftFirst + 1, current.second + 1 });
+			}
+		}
+
+		buildStats_.sahCost = rootArea > 0.0f ? float(totalCost / rootArea) : 0.0f;
+		buildStats_.averageLeafDepth = totalLeafDepth / double(buildStats_.leafNum);
+	}
+
+
+	bool BVH::Occluded(const float* origin, const float* direction) const
+	{
+		if (!isBuilt_) return false;
+
+		float invDirection[3];
+		for (int i = 0; i < 3; ++i)
+		{
+			invDirection[i] = 1.0f / direction[i];
+		}
+
+		if (IntersectNode(nodes_[0], origin, invDirection) == INF) return false;
+
+		UINT32 stack[MAX_DEPTH];
+		UINT32 stackSize = 0;
+		const BVHNode* node = &nodes_[0];
+
+		while (true)
+		{
+			if (node->count > 0) // leaf
+			{
+				for (UINT32 i = node->leftFirst; i < node->leftFirst + node->count; ++i)
+				{
+					if (IntersectTriangle(&triangles_[9ull * i], origin, direction)) return true;
+				}
+				if (stackSize == 0) break;
+				node = &nodes_[stack[--stackSize]];
+				continue;
+			}
+
+			// visit the nearest child first
+			UINT32 nearChild = node->leftFirst, farChild = node->leftFirst + 1;
+			float distNear = IntersectNode(nodes_[nearChild], origin, invDirection);
+			float distFar = IntersectNode(nodes_[farChild], origin, invDirection);
+			if (distNear > distFar)
+			{
+				std::swap(nearChild, farChild);
+				std::swap(distNear, distFar);
+			}
+
+			if (distNear == INF)
+			{
+				if (stackSize == 0) break;
+				node = &nodes_[stack[--stackSize]];
+			}
+			else
+			{
+				node = &nodes_[nearChild];
+				if (distFar != INF) stack[stackSize++] = farChild;
+			}
+		}
+
+		return false;
+	}
+
+	void BVH::OccludedPacket(const float* origin, const float* directionX, const float* directionY,
+		const float* directionZ, const UINT64& rayNum, UINT32* occluded) const
+	{
+		float packet[3][SIMD_WIDTH];
+		const float* directions[3] = { packet[0], packet[1], packet[2] };
+
+		for (UINT64 iRay = 0; iRay < rayNum; iRay += SIMD_WIDTH)
+		{
+			UINT32 numActive = (UINT32)(std::min)((UINT64)SIMD_WIDTH, rayNum - iRay);
+
+			// the final packet is padded with copies of its first ray
+			for (UINT32 i = 0; i < SIMD_WIDTH; ++i)
+			{
+				UINT64 iSource = iRay + (i < numActive ? i : 0);
+				packet[0][i] = directionX[iSource];
+				packet[1][i] = directionY[iSource];
+				packet[2][i] = directionZ[iSource];
+			}
+
+			UINT32 hitMask = isBuilt_ ? this->TracePacket(origin, directions, SIMDLaneMask(numActive)) : 0;
+
+			for (UINT32 i = 0; i < numActive; ++i)
+			{
+				occluded[iRay + i] = (hitMask >> i) & 1u;
+			}
+		}
+	}
+
+
+	bool BVH::HasOccluders(const float* origin, const float* normal) const
+	{
+		if (!isBuilt_) return false;
+
+		UINT32 stack[MAX_DEPTH];
+		UINT32 stackSize = 0;
+		UINT32 iNode = 0;
+
+		while (true)
+		{
+			const BVHNode& node = nodes_[iNode];
+
+			// the highest point of the box above the plane is the corner furthest along the normal
+			float height = 0.0f;
+			for (int i = 0; i < 3; ++i)
+			{
+				height += normal[i] * ((normal[i] > 0.0f ? node.boundsMax[i] : node.boundsMin[i]) - origin[i]);
+			}
+
+			if (height > 0.0f)
+			{
+				if (node.count == 0)
+				{
+					stack[stackSize++] = node.leftFirst + 1;
+					iNode = node.leftFirst;
+					continue;
+				}
+				for (UINT32 i = node.leftFirst; i < node.leftFirst + node.count; ++i)
+				{
+					if (CanOcclude(&triangles_[9ull * i], origin, normal)) return true;
+				}
+			}
+
+			if (stackSize == 0) break;
+			iNode = stack[--stackSize];
+		}
+
+		return false;
+	}
+
+
+
+	bool BVH::IsBuilt() const
+	{
+		return isBuilt_;
+	}
+
+	const BVHBuildStats& BVH::GetBuildStats() const
+	{
+		return buildStats_;
+	}
+
+	const BVHNode* BVH::GetNodes() const
+	{
+		return nodes_.data();
+	}
+
+	size_t BVH::GetNodeCount() const
+	{
+		return nodes_.size();
+	}
+
+	const float* BVH::GetTriangles() const
+	{
+		return triangles_.data();
+	}
+
+	const UINT32* BVH::GetTriangleIndices() const
+	{
+		return triangleIndices_.data();
+	}
+
+	size_t BVH::GetTriangleCount() const
+	{
+		return triangleIndices_.size();
+	}
+
+	size_t BVH::GetMemorySize() const
+	{
+		return nodes_.size() * sizeof(BVHNode) + triangles_.size() * sizeof(float) +
+			triangleIndices_.size() * sizeof(UINT32);
+	}
+
+
+	bool BVH::IntersectTriangle(const float* triangle, const float* origin,
+		const float* direction)
+	{
+		float vectors[3][3];
+		for (int j = 0; j < 3; ++j)
+		{
+			for (int i = 0; i < 3; ++i)
+			{
+				vectors[j][i] = triangle[3 * j + i] - origin[i];
+			}
+		}
+
+		float projectedAreas[3], cross12[3];
+		for (int j = 0; j < 3; ++j)
+		{
+			const float* a = vectors[j];
+			const float* b = vectors[(j + 1) % 3];
+			float edgeCross[3] = { a[1] * b[2] - a[2] * b[1], a[2] * b[0] - a[0] * b[2],
+				a[0] * b[1] - a[1] * b[0] };
+			projectedAreas[j] = edgeCross[0] * direction[0] + edgeCross[1] * direction[1] +
+				edgeCross[2] * direction[2];
+			if (j == 0)
+			{
+				cross12[0] = edgeCross[0];
+				cross12[1] = edgeCross[1];
+				cross12[2] = edgeCross[2];
+			}
+		}
+
+		if (!(projectedAreas[0] < 0.0f && projectedAreas[1] < 0.0f && projectedAreas[2] < 0.0f))
+		{
+			return false;
+		}
+
+		// the direction is a combination of the three vectors with coefficients of the same sign,
+		// these are positive (the triangle is in front of the origin) only if the triple product is negative
+		return cross12[0] * vectors[2][0] + cross12[1] * vectors[2][1] + cross12[2] * vectors[2][2] < 0.0f;
+	}
+
+
+	bool BVH::CanOcclude(const float* triangle, const float* origin, const float* normal)
+	{
+		float vectors[3][3];
+		bool isAbove = false;
+		for (int j = 0; j < 3; ++j)
+		{
+			for (int i = 0; i < 3; ++i)
+			{
+				vectors[j][i] = triangle[3 * j + i] - origin[i];
+			}
+			// the edges of a triangle touching the origin have no projected area, so it is never hit
+			if (vectors[j][0] == 0.0f && vectors[j][1] == 0.0f && vectors[j][2] == 0.0f) return false;
+			isAbove |= vectors[j][0] * normal[0] + vectors[j][1] * normal[1] + vectors[j][2] * normal[2] > 0.0f;
+		}
+		if (!isAbove) return false;
+
+		const float* a = vectors[0];
+		const float* b = vectors[1];
+		float cross01[3] = { a[1] * b[2] - a[2] * b[1], a[2] * b[0] - a[0] * b[2], a[0] * b[1] - a[1] * b[0] };
+		return cross01[0] * vectors[2][0] + cross01[1] * vectors[2][1] + cross01[2] * vectors[2][2] < 0.0f;
+	}
+
+
+	float BVH::IntersectNode(const BVHNode& node, const float* origin,
+		const float* invDirection)
+	{
+		float tMin = 0.0f, tMax = INF;
+		for (int i = 0; i < 3; ++i)
+		{
+			float t1 = (node.boundsMin[i] - origin[i]) * invDirection[i];
+			float t2 = (node.boundsMax[i] - origin[i]) * invDirection[i];
+			tMin = (std::max)(tMin, (std::min)(t1, t2));
+			tMax = (std::min)(tMax, (std::max)(t1, t2));
+		}
+		return tMin <= tMax ? tMin : INF;
+	}
+
+	// bounds of the reciprocal ray directions of a packet, forming a frustum about the packet
+	struct PacketFrustum
+	{
+		float invMin[3];
+		float invMax[3];
+		bool enabled;
+	};
+
+
+	// returns true if no ray within the frustum can hit the box of the node, using interval
+	// arithmetic on the slab test
+	static bool FrustumMissesNode(const PacketFrustum& frustum, const BVHNode& node, const float* origin)
+	{
+		if (!frustum.enabled) return false;
+
+		float tMin = 0.0f, tMax = INF;
+		for (int i = 0; i < 3; ++i)
+		{
+			float a = node.boundsMin[i] - origin[i];
+			float b = node.boundsMax[i] - origin[i];
+			float t1 = a * frustum.invMin[i], t2 = a * frustum.invMax[i];
+			float t3 = b * frustum.invMin[i], t4 = b * frustum.invMax[i];
+			tMin = (std::max)(tMin, (std::min)((std::min)(t1, t2), (std::min)(t3, t4)));
+			tMax = (std::min)(tMax, (std::max)((std::max)(t1, t2), (std::max)(t3, t4)));
+		}
+		return tMin > tMax;
+	}
+
+
+	// slab test of every ray of a packet against a node, returns the mask of rays that hit
+	// and the distance to the box of the nearest of these rays
+	static UINT32 IntersectNodePacket(const BVHNode& node, const SIMDFloat* origin,
+		const SIMDFloat* invDirection, const UINT32& activeMask, float& distance)
+	{
+		SIMDFloat tMin = SIMDSet(0.0f), tMax = SIMDSet(INF);
+		for (int i = 0; i < 3; ++i)
+		{
+			SIMDFloat t1 = (SIMDSet(node.boundsMin[i]) - origin[i]) * invDirection[i];
+			SIMDFloat t2 = (SIMDSet(node.boundsMax[i]) - origin[i]) * invDirection[i];
+			// NaN values (0 * inf) are ignored as the second argument is returned
+			tMin = SIMDMax(SIMDMin(t1, t2), tMin);
+			tMax = SIMDMin(SIMDMax(t1, t2), tMax);
+		}
+
+		UINT32 hitMask = SIMDLessEqual(tMin, tMax) & activeMask;
+
+		distance = INF;
+		if (hitMask != 0)
+		{
+			float tMinLanes[SIMD_WIDTH];
+			SIMDStore(tMinLanes, tMin);
+			for (UINT32 i = 0; i < SIMD_WIDTH; ++i)
+			{
+				if ((hitMask >> i) & 1u) distance = (std::min)(distance, tMinLanes[i]);
+			}
+		}
+		return hitMask;
+	}
+
+
+	UINT32 BVH::TracePacket(const float* origin, const float* const* directions,
+		const UINT32& activeMask) const
+	{
+		// the frustum is only used if every ray has the same sign in each component, such
+		// that the reciprocals lie within a finite interval
+		PacketFrustum frustum = {};
+		frustum.enabled = true;
+		for (int k = 0; k < 3 && frustum.enabled; ++k)
+		{
+			frustum.invMin[k] = INF;
+			frustum.invMax[k] = -INF;
+			bool positive = false, negative = false;
+			for (UINT32 i = 0; i < SIMD_WIDTH; ++i)
+			{
+				if (!((activeMask >> i) & 1u)) continue;
+				float inv = 1.0f / directions[k][i];
+				positive |= directions[k][i] > 0.0f;
+				negative |= !(directions[k][i] > 0.0f);
+				frustum.invMin[k] = (std::min)(frustum.invMin[k], inv);
+				frustum.invMax[k] = (std::max)(frustum.invMax[k], inv);
+			}
+			frustum.enabled = !(positive && negative) && std::isfinite(frustum.invMin[k]) &&
+				std::isfinite(frustum.invMax[k]);
+		}
+
+		SIMDFloat packetOrigin[3], direction[3], invDirection[3];
+		for (int k = 0; k < 3; ++k)
+		{
+			packetOrigin[k] = SIMDSet(origin[k]);
+			direction[k] = SIMDLoad(directions[k]);
+			invDirection[k] = SIMDSet(1.0f) / direction[k];
+		}
+
+		float distance;
+		UINT32 active = activeMask;
+		if (FrustumMissesNode(frustum, nodes_[0], origin) ||
+			IntersectNodePacket(nodes_[0], packetOrigin, invDirection, active, distance) == 0)
+		{
+			return 0;
+		}
+
+		UINT32 stack[MAX_DEPTH];
+		UINT32 stackSize = 0;
+		const BVHNode* node = &nodes_[0];
+		SIMDFloat zero = SIMDSet(0.0f);
+
+		while (true)
+		{
+			if (node->count > 0) // leaf
+			{
+				for (UINT32 i = node->leftFirst; i < node->leftFirst + node->count && active != 0; ++i)
+				{
+					// the same test as IntersectTriangle, the cross products of the vectors to the
+					// vertices are shared by the whole packet
+					const float* triangle = &triangles_[9ull * i];
+					float vectors[3][3];
+					for (int j = 0; j < 3; ++j)
+					{
+						for (int k = 0; k < 3; ++k)
+						{
+							vectors[j][k] = triangle[3 * j + k] - origin[k];
+						}
+					}
+
+					float edgeCross[3][3];
+					for (int j = 0; j < 3; ++j)
+					{
+						const float* a = vectors[j];
+						const float* b = vectors[(j + 1) % 3];
+						edgeCross[j][0] = a[1] * b[2] - a[2] * b[1];
+						edgeCross[j][1] = a[2] * b[0] - a[0] * b[2];
+						edgeCross[j][2] = a[0] * b[1] - a[1] * b[0];
+					}
+
+					// triangles behind the origin cannot be hit by any ray
+					if (!(edgeCross[0][0] * vectors[2][0] + edgeCross[0][1] * vectors[2][1] +
+						edgeCross[0][2] * vectors[2][2] < 0.0f)) continue;
+
+					UINT32 hitMask = active;
+					for (int j = 0; j < 3 && hitMask != 0; ++j)
+					{
+						SIMDFloat projectedArea = SIMDSet(edgeCross[j][0]) * direction[0] +
+							SIMDSet(edgeCross[j][1]) * direction[1] + SIMDSet(edgeCross[j][2]) * direction[2];
+						hitMask &= SIMDLess(projectedArea, zero);
+					}
+					active &= ~hitMask;
+				}
+
+				if (active == 0 || stackSize == 0) break;
+				node = &nodes_[stack[--stackSize]];
+				continue;
+			}
+
+			// visit the nearest child first, any child outside of the packet frustum is skipped
+			UINT32 nearChild = node->leftFirst, farChild = node->leftFirst + 1;
+			float distNear = INF, distFar = INF;
+			if (!FrustumMissesNode(frustum, nodes_[nearChild], origin))
+			{
+				IntersectNodePacket(nodes_[nearChild], packetOrigin, invDirection, active, distNear);
+			}
+			if (!FrustumMissesNode(frustum, nodes_[farChild], origin))
+			{
+				IntersectNodePacket(nodes_[farChild], packetOrigin, invDirection, active, distFar);
+			}
+			if (distNear > distFar)
+			{
+				std::swap(nearChild, farChild);
+				std::swap(distNear, distFar);
+			}
+
+			if (distNear == INF)
+			{
+				if (stackSize == 0) break;
+				node = &nodes_[stack[--stackSize]];
+			}
+			else
+			{
+				node = &nodes_[nearChild];
+				if (distFar != INF) stack[stackSize++] = farChild;
+			}
+		}
+
+		return activeMask & ~active;
+	}
+
+
+}
\ No newline at end of file
@@ -0,0 +1,499 @@
+/*
+*
+* Implimentation of BVH8.h
+*
+*
+* This file is part of the implimentation and is not intended for public
+* use.
+*
+*
+* Forms part of the DxPRT project
+*
+*
+*
+* Author: Shaun Bailey
+*
+* Date created: 16/10/2026
+*
+* Last Updated: 16/10/2026
+*
+*
+*
+* MIT License
+*
+* Copyright (c) 2021 Shaun Bailey
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*
+*/
+
+#include "DxPRT/BVH8.h"
+#include "DxPRT/BVH.h"
+#include "DxPRT/SIMD.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+
+namespace DxPRT_Utility {
+
+	static const UINT32 BVH8_LEAF_SIZE = BVH8_WIDTH; // subtrees with at most this many triangles become a single leaf
+	static const UINT32 STACK_SIZE = 64 * (BVH8_WIDTH - 1) + 1; // enough for the maximum depth of the binary BVH
+	static const float INF = std::numeric_limits<float>::infinity();
+
+
+	// half of the surface area of a box
+	static float HalfArea(const float* boundsMin, const float* boundsMax)
+	{
+		float extent[3];
+		for (int i = 0; i < 3; ++i)
+		{
+			extent[i] = boundsMax[i] - boundsMin[i];
+		}
+		return extent[0] * extent[1] + extent[1] * extent[2] + extent[2] * extent[0];
+	}
+
+
+	/*
+	* QuantizeAxis: finds the scale of a node along an axis and the quantized bounds of each
+	* child, such that each quantized box contains the box of the child. As the scale is a power
+	* of two, origin + q * scale is exact up to the final addition, which is checked directly
+	*
+	* _IN/OUT_ node: the node, origin must be set
+	* _IN_ axis: the axis
+	* _IN_ extent: the size of the box of the node along the axis
+	* _IN_ children: the binary nodes of the children
+	*/
+	static void QuantizeAxis(BVH8Node& node, const int& axis, const float& extent,
+		const std::vector<const BVHNode*>& children)
+	{
+		float origin = node.origin[axis];
+		float scale = 1.0f;
+		if (extent > 0.0f)
+		{
+			int exponent;
+			std::frexp(extent / 255.0f, &exponent);
+			scale = std::ldexp(1.0f, exponent);
+		}
+
+		// rounding in the addition may leave a child outside of the largest quantized value, in
+		// which case the scale is doubled
+		bool isContained = false;
+		while (!isContained)
+		{
+			isContained = true;
+			for (size_t i = 0; i < children.size() && isContained; ++i)
+			{
+				float childMin = children[i]->boundsMin[axis], childMax = children[i]->boundsMax[axis];
+
+				int qMin = (int)std::floor((childMin - origin) / scale);
+				qMin = (std::max)(0, (std::min)(qMin, 255));
+				while (qMin > 0 && origin + float(qMin) * scale > childMin) --qMin;
+
+				int qMax = (int)std::ceil((childMax - origin) / scale);
+				qMax = (std::max)(0, (std::min)(qMax, 255));
+				while (qMax < 255 && origin + float(qMax) * scale < childMax) ++qMax;
+
+				isContained = origin + float(qMin) * scale <= childMin && origin + float(qMax) * scale >= childMax;
+				node.boundsMin[axis][i] = (UINT8)qMin;
+				node.boundsMax[axis][i] = (UINT8)qMax;
+			}
+			if (!isContained) scale *= 2.0f;
+		}
+		node.scale[axis] = scale;
+	}
+
+
+	BVH8::BVH8() {}
+
+	BVH8::BVH8(const BVH& bvh)
+	{
+		this->Build(bvh);
+	}
+
+
+	void BVH8::Build(const BVH& bvh)
+	{
+		nodes_.clear();
+		blocks_.clear();
+		triangleNum_ = 0;
+		isBuilt_ = false;
+
+		if (!bvh.IsBuilt() || bvh.GetNodeCount() == 0) return;
+
+		const BVHNode* binaryNodes = bvh.GetNodes();
+		const float* triangles = bvh.GetTriangles();
+		size_t binaryNodeNum = bvh.GetNodeCount();
+
+		// the number of triangles and first triangle of each binary subtree. The triangles of a
+		// subtree are contiguous, and the children of a node always follow it in the array
+		std::vector<UINT32> subtreeCount(binaryNodeNum), subtreeFirst(binaryNodeNum);
+		for (size_t i = binaryNodeNum; i-- > 0;)
+		{
+			const BVHNode& node = binaryNodes[i];
+			if (node.count > 0)
+			{
+				subtreeCount[i] = node.count;
+				subtreeFirst[i] = node.leftFirst;
+			}
+			else
+			{
+				subtreeCount[i] = subtreeCount[node.leftFirst] + subtreeCount[node.leftFirst + 1];
+				subtreeFirst[i] = (std::min)(subtreeFirst[node.leftFirst], subtreeFirst[node.leftFirst + 1]);
+			}
+		}
+
+		// a binary subtree, or part of a large binary leaf
+		struct CollapseItem
+		{
+			const BVHNode* bounds;
+			UINT32 first, count;
+			bool isInterior; // an interior binary node with more than BVH8_LEAF_SIZE triangles
+		};
+
+		auto makeItem = [&](const UINT32& iBinary) {
+			const BVHNode& node = binaryNodes[iBinary];
+			CollapseItem item = { &node, subtreeFirst[iBinary], subtreeCount[iBinary], false };
+			item.isInterior = node.count == 0 && item.count > BVH8_LEAF_SIZE;
+			return item;
+		};
+
+		auto isLeaf = [](const CollapseItem& item) {
+			return !item.isInterior && item.count <= UINT8(~0);
+		};
+
+		// interior nodes are replaced by their children, while large leaves are split in half
+		auto openItem = [&](const CollapseItem& item, CollapseItem& left, CollapseItem& right) {
+			if (item.isInterior)
+			{
+				UINT32 leftChild = item.bounds->leftFirst;
+				left = makeItem(leftChild);
+				right = makeItem(leftChild + 1);
+			}
+			else
+			{
+				left = { item.bounds, item.first, item.count / 2, false };
+				right = { item.bounds, item.first + item.count / 2, item.count - item.count / 2, false };
+			}
+		};
+
+		blocks_.resize((bvh.GetTriangleCount() + BVH8_WIDTH - 1) / BVH8_WIDTH);
+
+		std::vector<std::pair<CollapseItem, UINT32>> stack; // (item, 8-wide node)
+		nodes_.push_back(BVH8Node());
+		stack.push_back({ makeItem(0), 0 });
+
+		std::vector<CollapseItem> children;
+		std::vector<const BVHNode*> childBounds;
+		while (!stack.empty())
+		{
+			auto current = stack.back();
+			stack.pop_back();
+			const CollapseItem& item = current.first;
+
+			// open the largest child until there are 8, leaves are never opened
+			children.clear();
+			if (isLeaf(item))
+			{
+				children.push_back(item);
+			}
+			else
+			{
+				children.resize(2);
+				openItem(item, children[0], children[1]);
+			}
+			while (children.size() < BVH8_WIDTH)
+			{
+				int iLargest = -1;
+				float largestArea = -INF;
+				for (size_t i = 0; i < children.size(); ++i)
+				{
+					if (isLeaf(children[i])) continue;
+					float area = HalfArea(children[i].bounds->boundsMin, children[i].bounds->boundsMax);
+					if (area > largestArea)
+					{
+						largestArea = area;
+						iLargest = (int)i;
+					}
+				}
+				if (iLargest == -1) break;
+
+				CollapseItem left, right;
+				openItem(children[iLargest], left, right);
+				children[iLargest] = left;
+				children.push_back(right);
+			}
+
+			childBounds.clear();
+			for (const CollapseItem& child : children) childBounds.push_back(child.bounds);
+
+			BVH8Node node = {};
+			node.childNum = (UINT8)children.size();
+			for (int axis = 0; axis < 3; ++axis)
+			{
+				node.origin[axis] = item.bounds->boundsMin[axis];
+				QuantizeAxis(node, axis, item.bounds->boundsMax[axis] - item.bounds->boundsMin[axis], childBounds);
+			}
+
+			for (size_t i = 0; i < children.size(); ++i)
+			{
+				const CollapseItem& child = children[i];
+				if (!isLeaf(child))
+				{
+					node.child[i] = (UINT32)nodes_.size();
+					nodes_.push_back(BVH8Node());
+					stack.push_back({ child, node.child[i] });
+					continue;
+				}
+
+				// the triangles of the leaf are packed after those of the previous leaf
+				node.leafMask |= 1u << i;
+				node.leafSize[i] = (UINT8)child.count;
+				node.child[i] = (UINT32)triangleNum_;
+				for (UINT32 j = 0; j < child.count; ++j, ++triangleNum_)
+				{
+					const float* triangle = &triangles[9ull * (child.first + j)];
+					BVH8TriangleBlock& block = blocks_[triangleNum_ / BVH8_WIDTH];
+					for (int k = 0; k < 9; ++k)
+					{
+						block.vertices[k][triangleNum_ % BVH8_WIDTH] = triangle[k];
+					}
+				}
+			}
+
+			nodes_[current.second] = node;
+		}
+
+		nodes_.shrink_to_fit();
+		isBuilt_ = true;
+	}
+
+
+	bool BVH8::Occluded(const float* origin, const float* direction) const
+	{
+		if (!isBuilt_) return false;
+
+		SIMDFloat8 rayOrigin[3], invDirection[3];
+		for (int k = 0; k < 3; ++k)
+		{
+			rayOrigin[k] = SIMD8Set(origin[k]);
+			invDirection[k] = SIMD8Set(1.0f / direction[k]);
+		}
+
+		UINT32 stack[STACK_SIZE];
+		UINT32 stackSize = 0;
+		UINT32 iNode = 0;
+
+		while (true)
+		{
+			const BVH8Node& node = nodes_[iNode];
+
+			// slab test of every child at once
+			SIMDFloat8 tMin = SIMD8Set(0.0f), tMax = SIMD8Set(INF);
+			for (int k = 0; k < 3; ++k)
+			{
+				SIMDFloat8 nodeOrigin = SIMD8Set(node.origin[k]), scale = SIMD8Set(node.scale[k]);
+				SIMDFloat8 t1 = (nodeOrigin + SIMD8LoadBytes(node.boundsMin[k]) * scale - rayOrigin[k]) * invDirection[k];
+				SIMDFloat8 t2 = (nodeOrigin + SIMD8LoadBytes(node.boundsMax[k]) * scale - rayOrigin[k]) * invDirection[k];
+				// NaN values (0 * inf) are ignored as the second argument is returned
+				tMin = SIMD8Max(SIMD8Min(t1, t2), tMin);
+				tMax = SIMD8Min(SIMD8Max(t1, t2), tMax);
+			}
+			UINT32 hitMask = SIMD8LessEqual(tMin, tMax) & SIMDLaneMask(node.childNum);
+
+			// the leaves are tested straight away, as any hit ends the query
+			UINT32 leafMask = hitMask & node.leafMask;
+			for (UINT32 i = 0; i < BVH8_WIDTH && leafMask != 0; ++i, leafMask >>= 1)
+			{
+				if ((leafMask & 1u) && this->IntersectLeaf(node.child[i], node.leafSize[i], origin, direction)) return true;
+			}
+
+			// push the interior children such that the nearest is visited first
+			UINT32 interiorMask = hitMask & ~UINT32(node.leafMask);
+			if (interiorMask != 0)
+			{
+				float distance[BVH8_WIDTH];
+				SIMD8Store(distance, tMin);
+				// insertion sort of the children by decreasing distance
+				UINT32 order[BVH8_WIDTH];
+				UINT32 orderNum = 0;
+				for (UINT32 i = 0; i < BVH8_WIDTH; ++i)
+				{
+					if (!((interiorMask >> i) & 1u)) continue;
+					UINT32 j = orderNum++;
+					while (j > 0 && distance[order[j - 1]] < distance[i])
+					{
+						order[j] = order[j - 1];
+						--j;
+					}
+					order[j] = i;
+				}
+				for (UINT32 j = 0; j < orderNum; ++j)
+				{
+					stack[stackSize++] = node.child[order[j]];
+				}
+			}
+
+			if (stackSize == 0) break;
+			iNode = stack[--stackSize];
+		}
+
+		return false;
+	}
+
+	void BVH8::OccludedPacket(const float* origin, const float* directionX, const float* directionY,
+		const float* directionZ, const UINT64& rayNum, UINT32* occluded) const
+	{
+		for (UINT64 iRay = 0; iRay < rayNum; ++iRay)
+		{
+			float direction[3] = { directionX[iRay], directionY[iRay], directionZ[iRay] };
+			occluded[iRay] = this->Occluded(origin, direction) ? 1u : 0u;
+		}
+	}
+
+
+	bool BVH8::HasOccluders(const float* origin, const float* normal) const
+	{
+		if (!isBuilt_) return false;
+
+		SIMDFloat8 zero = SIMD8Set(0.0f);
+		UINT32 stack[STACK_SIZE];
+		UINT32 stackSize = 0;
+		UINT32 iNode = 0;
+
+		while (true)
+		{
+			const BVH8Node& node = nodes_[iNode];
+
+			// the height above the plane of the furthest corner of every child at once
+			SIMDFloat8 height = zero;
+			for (int k = 0; k < 3; ++k)
+			{
+				SIMDFloat8 nodeOrigin = SIMD8Set(node.origin[k]), scale = SIMD8Set(node.scale[k]);
+				SIMDFloat8 planeOrigin = SIMD8Set(origin[k]), normalK = SIMD8Set(normal[k]);
+				height = height + SIMD8Max((nodeOrigin + SIMD8LoadBytes(node.boundsMin[k]) * scale - planeOrigin) * normalK,
+					(nodeOrigin + SIMD8LoadBytes(node.boundsMax[k]) * scale - planeOrigin) * normalK);
+			}
+			UINT32 aboveMask = SIMD8Less(zero, height) & SIMDLaneMask(node.childNum);
+
+			for (UINT32 i = 0; i < BVH8_WIDTH && aboveMask != 0; ++i, aboveMask >>= 1)
+			{
+				if (!(aboveMask & 1u)) continue;
+				if (!((node.leafMask >> i) & 1u))
+				{
+					stack[stackSize++] = node.child[i];
+					continue;
+				}
+				for (UINT32 iTriangle = node.child[i]; iTriangle < node.child[i] + node.leafSize[i]; ++iTriangle)
+				{
+					const BVH8TriangleBlock& block = blocks_[iTriangle / BVH8_WIDTH];
+					float triangle[9];
+					for (int j = 0; j < 9; ++j)
+					{
+						triangle[j] = block.vertices[j][iTriangle % BVH8_WIDTH];
+					}
+					if (BVH::CanOcclude(triangle, origin, normal)) return true;
+				}
+			}
+
+			if (stackSize == 0) break;
+			iNode = stack[--stackSize];
+		}
+
+		return false;
+	}
+
+
+	bool BVH8::IsBuilt() const
+	{
+		return isBuilt_;
+	}
+
+	size_t BVH8::GetNodeCount() const
+	{
+		return nodes_.size();
+	}
+
+	size_t BVH8::GetBlockCount() const
+	{
+		return blocks_.size();
+	}
+
+	size_t BVH8::GetMemorySize() const
+	{
+		return nodes_.size() * sizeof(BVH8Node) + blocks_.size() * sizeof(BVH8TriangleBlock);
+	}
+
+
+	bool BVH8::IntersectLeaf(const UINT32& first, const UINT32& count, const float* origin,
+		const float* direction) const
+	{
+		SIMDFloat8 zero = SIMD8Set(0.0f);
+		SIMDFloat8 rayOrigin[3] = { SIMD8Set(origin[0]), SIMD8Set(origin[1]), SIMD8Set(origin[2]) };
+		SIMDFloat8 rayDirection[3] = { SIMD8Set(direction[0]), SIMD8Set(direction[1]), SIMD8Set(direction[2]) };
+
+		// the leaf may start and end part of the way through a block, the other lanes are masked
+		UINT32 end = first + count;
+		for (UINT32 iBlock = first / BVH8_WIDTH; iBlock * BVH8_WIDTH < end; ++iBlock)
+		{
+			const BVH8TriangleBlock& block = blocks_[iBlock];
+			UINT32 blockStart = iBlock * BVH8_WIDTH;
+			UINT32 activeMask = SIMDLaneMask((std::min)(end - blockStart, BVH8_WIDTH));
+			if (first > blockStart) activeMask &= ~SIMDLaneMask(first - blockStart);
+
+			SIMDFloat8 vectors[3][3];
+			for (int j = 0; j < 3; ++j)
+			{
+				for (int k = 0; k < 3; ++k)
+				{
+					vectors[j][k] = SIMD8Load(block.vertices[3 * j + k]) - rayOrigin[k];
+				}
+			}
+
+			UINT32 hitMask = activeMask;
+			SIMDFloat8 cross12[3];
+			for (int j = 0; j < 3; ++j)
+			{
+				const SIMDFloat8* a = vectors[j];
+				const SIMDFloat8* b = vectors[(j + 1) % 3];
+				SIMDFloat8 edgeCross[3] = { a[1] * b[2] - a[2] * b[1], a[2] * b[0] - a[0] * b[2],
+					a[0] * b[1] - a[1] * b[0] };
+				SIMDFloat8 projectedArea = edgeCross[0] * rayDirection[0] + edgeCross[1] * rayDirection[1] +
+					edgeCross[2] * rayDirection[2];
+				hitMask &= SIMD8Less(projectedArea, zero);
+				if (j == 0)
+				{
+					cross12[0] = edgeCross[0];
+					cross12[1] = edgeCross[1];
+					cross12[2] = edgeCross[2];
+				}
+			}
+
+			// only triangles in front of the origin are hit, see BVH::IntersectTriangle
+			SIMDFloat8 tripleProduct = cross12[0] * vectors[2][0] + cross12[1] * vectors[2][1] +
+				cross12[2] * vectors[2][2];
+			hitMask &= SIMD8Less(tripleProduct, zero);
+
+			if (hitMask != 0) return true;
+		}
+
+		return false;
+	}
+
+}
@@ -0,0 +1,206 @@
+/*
+*
+* Implimentation of the GenerateEM_CPU_Utility.h
+*
+*
+* Forms part of the DxPRT project
+*
+*
+*
+* Author: Shaun Bailey
+*
+* Date created: 16/10/2026
+*
+* Last Updated: 16/10/2026
+*
+*
+*
+* MIT License
+*
+* Copyright (c) 2021 Shaun Bailey
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*
+*/
+
+#include "DxPRT/GenerateEM_CPU_Utility.h"
+#include "DxPRT/Sampling.h"
+#include "DxPRT/SphericalHarmonics.h"
+#include "DxPRT/ThreadPool.h"
+#include <algorithm>
+#include <cmath>
+#include <thread>
+
+using namespace DxPRT;
+
+namespace DxPRT_Utility {
+
+    static const float PI = 3.14159265f;
+    static const UINT64 SH_BLOCK_SIZE = 256; // number of directions passed to CalcSHDirections at once
+
+
+    EMCPUConstantContainer InitializeEMCPUConstants(const DxPRT::EM_DESC& desc, const UINT64& numPixelsX,
+        const UINT64& numPixelsY) {
+        EMCPUConstantContainer constants = {};
+        constants.maxL = desc.MaxL;
+        constants.nCoefficients = (desc.MaxL + 1) * (desc.MaxL + 1);
+        constants.numPixelsX = numPixelsX;
+        constants.numPixelsY = numPixelsY;
+
+        UINT64 numEventsX; // not needed on the CPU, but the events are rounded to match the GPU
+        RoundInput(desc.NumEvents, desc.SHGridNum, constants.numEvents,
+            numEventsX, constants.shGridNum);
+
+        constants.numThreads = desc.NumThreads;
+        if (constants.numThreads == 0) constants.numThreads = std::thread::hardware_concurrency();
+        if (constants.numThreads == 0) constants.numThreads = 1; // hardware_concurrency may not be known
+
+        constants.sampling = desc.Sampling;
+        constants.latticeGenerator = LatticeGenerator(constants.numEvents);
+        constants.seed = desc.Seed;
+
+        return constants;
+    }
+
+
+    void SampleEnvironmentMap(float* colour, const float* data, const EMCPUConstantContainer& constants,
+        const float& u, const float& v) {
+
+        // texel centres are at (i + 0.5) / numPixels
+        float x = u * float(constants.numPixelsX) - 0.5f;
+        float y = v * float(constants.numPixelsY) - 0.5f;
+        float xFloor = floor(x);
+        float yFloor = floor(y);
+        float xFrac = x - xFloor;
+        float yFrac = y - yFloor;
+
+        long long maxX = (long long)constants.numPixelsX - 1, maxY = (long long)constants.numPixelsY - 1;
+        long long x0 = (long long)xFloor, y0 = (long long)yFloor;
+        long long x1 = x0 + 1, y1 = y0 + 1;
+        x0 = x0 < 0 ? 0 : (x0 > maxX ? maxX : x0);
+        x1 = x1 < 0 ? 0 : (x1 > maxX ? maxX : x1);
+        y0 = y0 < 0 ? 0 : (y0 > maxY ? maxY : y0);
+        y1 = y1 < 0 ? 0 : (y1 > maxY ? maxY : y1);
+
+        const float* p00 = data + (y0 * constants.numPixelsX + x0) * 3;
+        const float* p01 = data + (y0 * constants.numPixelsX + x1) * 3;
+        const float* p10 = data + (y1 * constants.numPixelsX + x0) * 3;
+        const float* p11 = data + (y1 * constants.numPixelsX + x1) * 3;
+
+        for (int i = 0; i < 3; ++i) {
+            float top = p00[i] * (1.0f - xFrac) + p01[i] * xFrac;
+            float bottom = p10[i] * (1.0f - xFrac) + p11[i] * xFrac;
+            colour[i] = top * (1.0f - yFrac) + bottom * yFrac;
+        }
+    }
+
+
+    // buffers owned by a single thread, holding a block of events
+    struct alignas(64) EMThreadScratch {
+        std::vector<float> directionX, directionY, directionZ;
+        std::vector<float> red, green, blue;
+        std::vector<float> shBlock;
+    };
+
+
+    void IntegrateEM(std::vector<float>& coefficients, const float* data,
+        const EMCPUConstantContainer& constants) {
+
+        // a single stream and randomization is used for the whole integral
+        RandomStream stream = InitializeRandomStream(constants.seed, 0);
+        SampleScramble scramble = {};
+        if (constants.sampling != SAMPLING_PSEUDO_RANDOM) scramble = InitializeScramble(stream);
+
+        // the events are summed over fixed ranges, which are then added in order, such that the
+        // result does not depend on the number of threads or which thread processes each range
+        const UINT64 rangeSize = 4096;
+        UINT64 numRanges = (constants.numEvents + rangeSize - 1) / rangeSize;
+        std::vector<double> rangeTotals(numRanges * constants.nCoefficients * 3, 0.0);
+
+        ThreadPool threadPool(constants.numThreads);
+
+        std::vector<EMThreadScratch> scratch(threadPool.GetNumThreads());
+        for (EMThreadScratch& threadScratch : scratch) {
+            threadScratch.directionX.resize(SH_BLOCK_SIZE);
+            threadScratch.directionY.resize(SH_BLOCK_SIZE);
+            threadScratch.directionZ.resize(SH_BLOCK_SIZE);
+            threadScratch.red.resize(SH_BLOCK_SIZE);
+            threadScratch.green.resize(SH_BLOCK_SIZE);
+            threadScratch.blue.resize(SH_BLOCK_SIZE);
+            threadScratch.shBlock.resize(constants.nCoefficients * SH_BLOCK_SIZE);
+        }
+
+        threadPool.ParallelFor(constants.numEvents, rangeSize, [&](UINT64 iThread, UINT64 begin, UINT64 end) {
+
+            double* total = &rangeTotals[(begin / rangeSize) * constants.nCoefficients * 3];
+            EMThreadScratch& threadScratch = scratch[iThread];
+
+            for (UINT64 blockBegin = begin; blockBegin < end; blockBegin += SH_BLOCK_SIZE) {
+                UINT64 n = (std::min)(SH_BLOCK_SIZE, end - blockBegin);
+
+                for (UINT64 i = 0; i < n; ++i) {
+                    float random1, random2;
+                    DrawSample(constants.sampling, blockBegin + i, constants.numEvents, constants.latticeGenerator,
+                        scramble, stream, random1, random2);
+
+                    float theta = acos(sqrt(1.0f - random1)) / (PI / 2.0f);
+                    float phi = random2;
+
+                    float colour[3];
+                    SampleEnvironmentMap(colour, data, constants, 1.0f - phi, theta); // phi and theta swapped in hdr file
+                    threadScratch.red[i] = colour[0];
+                    threadScratch.green[i] = colour[1];
+                    threadScratch.blue[i] = colour[2];
+
+                    // theta and phi are the texture coordinates of the spherical harmonic grids,
+                    // converted here to the direction with the global coordinates used by the shaders
+                    float sinTheta = sin(theta * PI);
+                    threadScratch.directionX[i] = -sinTheta * cos(phi * 2.0f * PI);
+                    threadScratch.directionY[i] = cos(theta * PI);
+                    threadScratch.directionZ[i] = -sinTheta * sin(phi * 2.0f * PI);
+                }
+
+                CalcSHDirections(constants.maxL, n, &threadScratch.directionX[0], &threadScratch.directionY[0],
+                    &threadScratch.directionZ[0], &threadScratch.shBlock[0]);
+
+                for (UINT64 j = 0; j < constants.nCoefficients; ++j) {
+                    const float* sh = &threadScratch.shBlock[j * n];
+                    float blockTotal[] = { 0.0f, 0.0f, 0.0f };
+                    for (UINT64 i = 0; i < n; ++i) {
+                        blockTotal[0] += sh[i] * threadScratch.red[i];
+                        blockTotal[1] += sh[i] * threadScratch.green[i];
+                        blockTotal[2] += sh[i] * threadScratch.blue[i];
+                    }
+                    for (int k = 0; k < 3; ++k) {
+                        total[j * 3 + k] += blockTotal[k];
+                    }
+                }
+            }
+        });
+
+        for (UINT64 j = 0; j < constants.nCoefficients * 3; ++j) {
+            double total = 0.0;
+            for (UINT64 iRange = 0; iRange < numRanges; ++iRange) {
+                total += rangeTotals[iRange * constants.nCoefficients * 3 + j];
+            }
+            coefficients.push_back(float(total / double(constants.numEvents) * 4.0 * 3.14159));
+        }
+    }
+
+}
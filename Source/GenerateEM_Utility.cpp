@@ -56,6 +56,7 @@ namespace DxPRT_Utility {
         RoundInput(desc.NumEvents, desc.SHGridNum, constants.numEvents,
             constants.numEventsX, constants.shGridNum);
         constants.numThreadGroups = constants.numEvents / (8 * 8);
+        constants.seed = desc.Seed;
 
         return constants;
     }
@@ -63,7 +64,7 @@ namespace DxPRT_Utility {
 
     void InitializeEMResources(ID3D12Device* device, CommandQueue& commandQueue, CommandList& commandList,
         EMResourceContainer& resources, const EMConstantContainer& constants,
-        const void* data, const std::vector<std::vector<float>>& shData,
+        const void* data, const SHTable& shTable,
         const std::vector<UINT32>& randomVector) {
 
         commandList.Reset();
@@ -92,7 +93,7 @@ namespace DxPRT_Utility {
         for (int i = 0; i < constants.nCoefficients; ++i) {
             resources.shRes[i].SetTex2D(DXGI_FORMAT_R32_FLOAT, constants.shGridNum, constants.shGridNum, 4);
             resources.shRes[i].SetState(D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE);
-            resources.shRes[i].InitializeWithData(device, commandList.GetCommandList(), &shData[i][0]);
+            resources.shRes[i].InitializeWithData(device, commandList.GetCommandList(), shTable.GetGrid(i));
         }
 
         commandList.Close();
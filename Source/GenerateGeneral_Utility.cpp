@@ -39,38 +39,27 @@
 */
 
 #include "DxPRT/GenerateGeneral_Utility.h"
+#include "DxPRT/PRTBinary.h"
+#include "DxPRT/Sampling.h"
+#include <cmath>
 
 
 namespace DxPRT_Utility {
 
-    void GenerateSHvector(const UINT64& shGridNum, const UINT64& maxL, std::vector<std::vector<float>>& shVector) {
-
-        const float PI = 3.1315927f;
-
-        const int nCoefficients = (maxL + 1) * (maxL + 1);
-
-        for (int i = 0; i < shGridNum; ++i) {
-            for (int j = 0; j < shGridNum; ++j) {
-                float theta = (PI) * float(j) / float(shGridNum - 1);
-                float phi = 2.0f * PI * float(i) / float(shGridNum - 1);
-                std::vector<float> sh = CalcSH(maxL, cos(theta), phi);
-                for (int k = 0; k < nCoefficients; ++k) {
-                    shVector[k].push_back(sh[k]);
-                }
-            }
-        }
-    }
-
-
-    void GenerateRandomVector(const UINT64& numEvents, std::vector<UINT32>& randomVector)
+    void GenerateRandomVector(const UINT64& numEvents, std::vector<UINT32>& randomVector,
+        const UINT64& seed)
     {
         randomVector.resize(numEvents * 8, 0);
-        srand((unsigned)time(NULL));
+        RandomStream stream = InitializeRandomStream(seed, 0);
+        UINT64 index = 0;
+        UINT32 random[4];
         for (auto iter = randomVector.begin(); iter != randomVector.end();
             ++iter) {
             // seeds of pseudo-random number generator must be greater than 128
             while (*iter < 128) {
-                *iter = rand() % int(pow(2, 32));
+                if (index % 4 == 0) RandomIntegers(stream, index / 4, random);
+                *iter = random[index % 4];
+                ++index;
             }
         }
     }
@@ -88,4 +77,19 @@ namespace DxPRT_Utility {
 
     }
 
+
+    UINT64 PRTSettingsKey(const DxPRT::PRT_DESC& desc, const float* pNormal, const UINT64& vertexNum) {
+
+        // the thread count and output settings do not change the coefficients, so are left out
+        const UINT64 settings[] = { desc.MaxL, desc.NumEvents, desc.SHGridNum, (UINT64)desc.Backend,
+            desc.PacketTraversal, desc.WideBVH, desc.MortonBVH, desc.AnalyticUnoccluded,
+            desc.ControlVariate, (UINT64)desc.Visibility, desc.HemicubeResolution,
+            (UINT64)desc.Sampling, desc.Seed };
+
+        PRTChecksum checksum;
+        UpdatePRTChecksum(checksum, settings, sizeof(settings));
+        UpdatePRTChecksum(checksum, pNormal, vertexNum * 3 * sizeof(float));
+        return FinalizePRTChecksum(checksum);
+    }
+
 }
@@ -44,6 +44,8 @@
 */
 
 #include "DxPRT/GeneratePRT.h"
+#include <algorithm>
+#include <future>
 
 using namespace DxPRT_Utility;
 
@@ -54,6 +56,16 @@ namespace DxPRT {
         const UINT64& numPixelsX, const UINT64& numPixelsY,
         const std::string& outFile, const EM_DESC& desc) {
 
+        if (desc.Backend == PRT_BACKEND_CPU) { // no device needed (see GeneratePRT_CPU.h)
+            GenerateEM(data, numPixelsX, numPixelsY, outFile, desc);
+            return;
+        }
+
+        if (desc.Sampling != SAMPLING_PSEUDO_RANDOM) {
+            OutputDebugStringA("DxPRT: Quasi-Monte Carlo sampling is only supported by the CPU backend,"
+                " pseudo-random numbers are used instead.\n");
+        }
+
         if (!desc.SuppressOutput) std::cout << "Initializing" << std::endl;
 
         // set up command queue
@@ -64,17 +76,17 @@ namespace DxPRT {
         EMConstantContainer constants = InitializeEMConstants(desc, numPixelsX,
             numPixelsY);
 
-        std::vector<std::vector<float>> shData(constants.nCoefficients);
-        GenerateSHvector(constants.shGridNum, constants.maxL, shData);
+        std::shared_ptr<const SHTable> shTable = SHTable::GetShared(constants.shGridNum, constants.maxL,
+            desc.SHGridTable);
 
         std::vector<UINT32> randomVector;
-        GenerateRandomVector(constants.numEvents, randomVector);
+        GenerateRandomVector(constants.numEvents, randomVector, constants.seed);
 
         EMResourceContainer resources;
         InitializeEMResources(device, commandQueue, commandList, resources,
-            constants, data, shData, randomVector);
+            constants, data, *shTable, randomVector);
 
-        shData.clear(); // clear up CPU
+        shTable.reset(); // clear up CPU
         randomVector.clear();
         resources.hdrRes.ReleaseUpload();
         resources.randomRes.ReleaseUpload();
@@ -104,7 +116,7 @@ namespace DxPRT {
 
         outPRTFile.AddCoefficients(desc.MaxL, &coefficients[0], coefficients.size());
 
-        if (!outPRTFile.Write(outFile, true)) {
+        if (!outPRTFile.Write(outFile, true, desc.OutputFormat)) {
             std::string warningMessage = "DxPRT: Unable to write to file " + outFile + ". Please provide a location" +
                 " that can be accessed\n.";
             OutputDebugStringA(warningMessage.c_str());
@@ -140,6 +152,17 @@ namespace DxPRT {
         void* normalData, const std::string& outFile,
         const PRT_DESC& desc) {
 
+        if (desc.Backend == PRT_BACKEND_CPU) { // no device needed (see GeneratePRT_CPU.h)
+            GeneratePRT(vertexData, vertexNum, indexData, triangleNum, normalData,
+                outFile, desc);
+            return;
+        }
+
+        if (desc.Sampling != SAMPLING_PSEUDO_RANDOM) {
+            OutputDebugStringA("DxPRT: Quasi-Monte Carlo sampling is only supported by the CPU backend,"
+                " pseudo-random numbers are used instead.\n");
+        }
+
         if (!desc.SuppressOutput) std::cout << "Initializing" << std::endl;
 
         CommandQueue commandQueue(device, D3D12_COMMAND_LIST_TYPE_COMPUTE);
@@ -155,7 +178,7 @@ namespace DxPRT {
 
         PRTConstantContainer constants = InitializePRTConstants(desc, triangleNum, vertexNum);
         InitalizePRTDataContainer(dataContainer, constants, (float*)vertexData, (UINT32*)indexData,
-            (float*)normalData, vertexNum, triangleNum);
+            (float*)normalData, vertexNum, triangleNum, desc.SHGridTable);
         InitializePRTResources(device, commandQueue, commandList, resources,
             constants, dataContainer);
         CleanUpPRT(dataContainer, resources, constants);
@@ -170,15 +193,45 @@ namespace DxPRT {
         float* pVertex = (float*)vertexData;
         float* pNormal = (float*)normalData;
 
-        std::vector<float> coefficients; // final result
+        // the binary format is written as the coefficients are completed, such that only two blocks of
+        // vertices are held in memory, while the text format is written once every vertex is complete.
+        // Each full block is written on another thread while the next block is calculated
+        bool isStreamed = desc.OutputFormat == PRT_FILE_FORMAT_BINARY;
+        UINT64 blockSize = (std::min)(vertexNum, PRT_STREAM_VERTEX_NUM) * constants.nCoefficients;
+        std::vector<float> coefficients(isStreamed ? 2 * blockSize : vertexNum * constants.nCoefficients); // final result
+        PRTStreamWriter streamWriter;
+        std::future<bool> blockWritten; // the write of the previous block
+        bool isWritten = true;
+
+        if (isStreamed) {
+            if (!desc.SuppressOutput) std::cout << "Writing to file: " << outFile << std::endl;
+            UINT64 settingsKey = PRTSettingsKey(desc, pNormal, vertexNum);
+            isWritten = desc.ResumeOutput ?
+                streamWriter.Resume(outFile, (int)desc.MaxL, pVertex, vertexNum * 3, (UINT32*)indexData,
+                    triangleNum * 3, settingsKey) :
+                streamWriter.Open(outFile, (int)desc.MaxL, pVertex, vertexNum * 3, (UINT32*)indexData,
+                    triangleNum * 3, settingsKey);
+            if (!desc.SuppressOutput && streamWriter.GetNumVerticesWritten() > 0) std::cout << "Resuming with "
+                << streamWriter.GetNumVerticesWritten() << " vertices already written" << std::endl;
+        }
 
         if (!desc.SuppressOutput) std::cout << "Calculating coefficients" << std::endl;
 
-        for (int i = 0; i < vertexNum; ++i) {
+        for (UINT64 i = 0; i < vertexNum && isWritten; ++i) {
+
+            // blocks written before an earlier call was interrupted are not calculated again
+            UINT64 blockEnd = (std::min)(i + PRT_STREAM_VERTEX_NUM, vertexNum);
+            if (isStreamed && i % PRT_STREAM_VERTEX_NUM == 0 && streamWriter.IsRangeWritten(i, blockEnd)) {
+                pVertex += 3 * (blockEnd - i);
+                pNormal += 3 * (blockEnd - i);
+                i = blockEnd - 1;
+                continue;
+            }
 
             if (i % 100 == 0 && !desc.SuppressOutput) {
-                std::cout << i << " out of " << vertexNum << " vertices processed"
-                    << std::endl;
+                std::cout << i << " out of " << vertexNum << " vertices processed";
+                if (isStreamed) std::cout << ", " << streamWriter.GetNumVerticesWritten() << " written to file";
+                std::cout << std::endl;
             }
 
             rayData.rayPos = DirectX::XMFLOAT4(*pVertex, *(pVertex + 1), *(pVertex + 2), 0.0f); //root constants
@@ -199,7 +252,19 @@ namespace DxPRT {
             commandQueue.Signal();
             commandQueue.WaitForFence();
 
-            StorePRTResult(coefficients, resources, constants);
+            UINT64 iResult = isStreamed ? i % PRT_STREAM_VERTEX_NUM : i;
+            float* block = &coefficients[isStreamed ? (i / PRT_STREAM_VERTEX_NUM % 2) * blockSize : 0];
+            StorePRTResult(&block[iResult * constants.nCoefficients], resources, constants);
+
+            // the block is written once full or once the last vertex is complete. The write of the
+            // previous block must finish first, as the next block is stored in its place
+            if (isStreamed && (iResult + 1 == PRT_STREAM_VERTEX_NUM || i + 1 == vertexNum)) {
+                if (blockWritten.valid() && !blockWritten.get()) isWritten = false;
+                UINT64 begin = i - iResult, end = i + 1;
+                blockWritten = std::async(std::launch::async, [&streamWriter, block, begin, end]() {
+                    return streamWriter.WriteVertices(begin, end, block);
+                });
+            }
 
             pVertex += 3;
             pNormal += 3;
@@ -207,15 +272,23 @@ namespace DxPRT {
 
         }
 
-        if (!desc.SuppressOutput) std::cout << "Writing to file: " << outFile << std::endl;
+        if (isStreamed) {
+            if (blockWritten.valid() && !blockWritten.get()) isWritten = false;
+            isWritten = isWritten && streamWriter.Finish();
+        }
+        else {
+            if (!desc.SuppressOutput) std::cout << "Writing to file: " << outFile << std::endl;
 
-        PRTWriter outPRTFile;
+            PRTWriter outPRTFile;
 
-        outPRTFile.AddVertices((float*)vertexData, vertexNum * 3);
-        outPRTFile.AddCoefficients(desc.MaxL, &coefficients[0], coefficients.size());
-        outPRTFile.AddIndices((UINT32*)indexData, triangleNum * 3);
+            outPRTFile.AddVertices((float*)vertexData, vertexNum * 3);
+            outPRTFile.AddCoefficients(desc.MaxL, &coefficients[0], coefficients.size());
+            outPRTFile.AddIndices((UINT32*)indexData, triangleNum * 3);
+
+            isWritten = outPRTFile.Write(outFile, false, desc.OutputFormat);
+        }
 
-        if (!outPRTFile.Write(outFile)) {
+        if (!isWritten) {
             std::string warningMessage = "DxPRT: Unable to write to file " + outFile + ". Please provide a location" +
                 " that can be accessed\n.";
             OutputDebugStringA(warningMessage.c_str());
@@ -226,15 +299,29 @@ namespace DxPRT {
 
     }
 
-    void GeneratePRT(ID3D12Device* device, const std::string& objFile,
+    void GeneratePRT(ID3D12Device* device, const std::string& meshFile,
         const std::string& outFile, const PRT_DESC& desc) {
 
-        if (!desc.SuppressOutput) std::cout << "Reading file: " << objFile << std::endl;
+        if (!desc.SuppressOutput) std::cout << "Reading file: " << meshFile << std::endl;
+
+        std::string warningMessage = "DxPRT: Unable to read mesh file: " + meshFile + ". Please use a valid file" +
+            " and check the README document to ensure that it is supported\n.";
+
+        if (IsPlyFile(meshFile)) {
+            PlyReader ply;
+            if (!ply.Load(meshFile)) {
+                OutputDebugStringA(warningMessage.c_str());
+                return;
+            }
+
+            GeneratePRT(device, ply.GetVertices(), ply.GetSizeVertices() / 3,
+                ply.GetIndices(), ply.GetSizeIndices() / 3, ply.GetNormals(),
+                outFile, desc);
+            return;
+        }
 
         ObjReader obj;
-        if (!obj.Load(objFile)) {
-            std::string warningMessage = "DxPRT: Unable to read obj file: " + outFile + ". Please use a valid file" +
-                " and check the README document to ensure that it is supported\n.";
+        if (!obj.Load(meshFile)) {
             OutputDebugStringA(warningMessage.c_str());
             return;
         }
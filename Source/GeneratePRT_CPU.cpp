@@ -0,0 +1,259 @@
+/*
+*
+* Implimentation of GeneratePRT_CPU.h
+*
+* Many of the functions and structures used here are defined in:
+*   GeneratePRT_CPU_Utility.h
+*   GenerateGeneral_Utility.h
+*
+*
+* Forms part of the DxPRT project
+*
+*
+*
+* Author: Shaun Bailey
+*
+* Date created: 16/10/2026
+*
+* Last Updated: 16/10/2026
+*
+*
+*
+* MIT License
+*
+* Copyright (c) 2021 Shaun Bailey
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*
+*/
+
+#include "DxPRT/GeneratePRT_CPU.h"
+#include "DxPRT/GeneratePRT_CPU_Utility.h"
+#include "DxPRT/GenerateEM_CPU_Utility.h"
+#include "DxPRT/PRTWriter.h"
+#include "DxPRT/ObjReader.h"
+#include "DxPRT/PlyReader.h"
+#include "DxPRT/HDRReader.h"
+#include "DxPRT/ThreadPool.h"
+#include <atomic>
+#include <iostream>
+#include <mutex>
+
+using namespace DxPRT_Utility;
+
+namespace DxPRT {
+
+    void GenerateEM(void* data, const UINT64& numPixelsX, const UINT64& numPixelsY,
+        const std::string& outFile, const EM_DESC& desc) {
+
+        if (!desc.SuppressOutput) std::cout << "Initializing" << std::endl;
+
+        EMCPUConstantContainer constants = InitializeEMCPUConstants(desc, numPixelsX, numPixelsY);
+
+        if (!desc.SuppressOutput) std::cout << "Calculating coefficients on " << constants.numThreads
+            << " threads" << std::endl;
+
+        std::vector<float> coefficients;
+        IntegrateEM(coefficients, (float*)data, constants);
+
+        if (!desc.SuppressOutput) std::cout << "Writing file" << std::endl;
+
+        PRTWriter outPRTFile;
+
+        outPRTFile.AddCoefficients((int)desc.MaxL, &coefficients[0], coefficients.size());
+
+        if (!outPRTFile.Write(outFile, true, desc.OutputFormat)) {
+            std::string warningMessage = "DxPRT: Unable to write to file " + outFile + ". Please provide a location" +
+                " that can be accessed\n.";
+            OutputDebugStringA(warningMessage.c_str());
+        }
+
+        if (!desc.SuppressOutput) std::cout << "Finished writing to file: " << outFile << std::endl;
+
+    }
+
+    void GenerateEM(const std::string& hdrFile, const std::string& outFile, const EM_DESC& desc) {
+
+        if (!desc.SuppressOutput) std::cout << "Reading file: " << hdrFile << std::endl;
+
+        HDRReader hdr;
+        if (!hdr.Load(hdrFile)) {
+            std::string warningMessage = "DxPRT: Unable to read hdr file: " + hdrFile + ". Please use a valid file" +
+                " and check the README document to ensure that it is supported.\n";
+            OutputDebugStringA(warningMessage.c_str());
+            return;
+        }
+
+        GenerateEM(hdr.GetData(), hdr.GetNPixelsX(), hdr.GetNPixelsY(), outFile, desc);
+
+    }
+
+    void GeneratePRT(void* vertexData, const UINT64& vertexNum, void* indexData,
+        const UINT64& triangleNum, void* normalData, const std::string& outFile,
+        const PRT_DESC& desc) {
+
+        if (!desc.SuppressOutput) std::cout << "Initializing" << std::endl;
+
+        PRTCPUConstantContainer constants = InitializePRTCPUConstants(desc, triangleNum, vertexNum);
+
+        PRTCPUDataContainer dataContainer;
+        InitializePRTCPUDataContainer(dataContainer, constants, (float*)vertexData,
+            (UINT32*)indexData, (float*)normalData);
+
+        if (!desc.SuppressOutput && constants.visibility == VISIBILITY_HEMICUBE) {
+            std::cout << "Rasterizing " << constants.triangleNum << " triangles per vertex into a hemicube of "
+                << constants.hemicubeResolution << " pixels" << std::endl;
+        }
+        else if (!desc.SuppressOutput) {
+            const BVHBuildStats& stats = dataContainer.bvhStats;
+            std::cout << "Built BVH in " << stats.buildTime << " s: " << stats.nodeNum << " nodes, depth "
+                << stats.maxDepth << ", SAH cost " << stats.sahCost << std::endl;
+            if (constants.wideBVH) std::cout << "Collapsed to " << dataContainer.wideBVH.GetNodeCount()
+                << " 8-wide nodes, " << dataContainer.wideBVH.GetMemorySize() / 1024 << " KB" << std::endl;
+        }
+
+        std::vector<CPUThreadScratch> scratch;
+        InitializeCPUThreadScratch(scratch, constants);
+
+        ThreadPool threadPool(constants.numThreads);
+
+        const float* pVertex = (float*)vertexData;
+        const float* pNormal = (float*)normalData;
+
+        // the binary format is written as the coefficients are completed, such that each thread only
+        // holds a block of vertices in memory, while the text format is written once every vertex is
+        // complete
+        bool isStreamed = desc.OutputFormat == PRT_FILE_FORMAT_BINARY;
+        std::vector<float> coefficients(isStreamed ? 0 : vertexNum * constants.nCoefficients); // final result
+        std::vector<std::vector<float>> blocks(isStreamed ? threadPool.GetNumThreads() : 0,
+            std::vector<float>(PRT_STREAM_VERTEX_NUM * constants.nCoefficients));
+        PRTStreamWriter streamWriter;
+        std::atomic<bool> isWritten(true);
+
+        if (isStreamed) {
+            if (!desc.SuppressOutput) std::cout << "Writing to file: " << outFile << std::endl;
+            UINT64 settingsKey = PRTSettingsKey(desc, pNormal, vertexNum);
+            isWritten = desc.ResumeOutput ?
+                streamWriter.Resume(outFile, (int)desc.MaxL, pVertex, vertexNum * 3, (UINT32*)indexData,
+                    triangleNum * 3, settingsKey) :
+                streamWriter.Open(outFile, (int)desc.MaxL, pVertex, vertexNum * 3, (UINT32*)indexData,
+                    triangleNum * 3, settingsKey);
+            if (!desc.SuppressOutput && streamWriter.GetNumVerticesWritten() > 0) std::cout << "Resuming with "
+                << streamWriter.GetNumVerticesWritten() << " vertices already written" << std::endl;
+        }
+
+        if (!desc.SuppressOutput) std::cout << "Calculating coefficients on " << constants.numThreads
+            << " threads" << std::endl;
+
+        std::atomic<UINT64> verticesProcessed(0), verticesUnoccluded(0);
+        std::mutex outputMutex;
+
+        // the vertices are independent, each writes straight to its own slot of the result
+        threadPool.ParallelFor(vertexNum, isStreamed ? PRT_STREAM_VERTEX_NUM : 0,
+            [&](UINT64 iThread, UINT64 begin, UINT64 end) {
+
+            if (!isWritten) return; // no point continuing if the results cannot be stored
+
+            // blocks written before an earlier call was interrupted are not calculated again
+            bool isResumed = isStreamed && streamWriter.IsRangeWritten(begin, end);
+
+            CPURayData rayData;
+            UINT64 unoccluded = 0;
+            float* result = isStreamed ? &blocks[iThread][0] : &coefficients[begin * constants.nCoefficients];
+
+            for (UINT64 i = begin; i < end && !isResumed; ++i) {
+
+                InitializeCPURayData(rayData, &pVertex[i * 3], &pNormal[i * 3]);
+
+                if (IntegrateVertex(&result[(i - begin) * constants.nCoefficients], scratch[iThread],
+                    dataContainer, constants, rayData, i)) ++unoccluded;
+            }
+            verticesUnoccluded += unoccluded;
+
+            if (isStreamed && !isResumed && !streamWriter.WriteVertices(begin, end, result)) isWritten = false;
+
+            UINT64 processed = verticesProcessed += end - begin;
+            if ((processed - (end - begin)) / 100 != processed / 100 && !desc.SuppressOutput) {
+                std::lock_guard<std::mutex> lock(outputMutex);
+                std::cout << processed << " out of " << vertexNum << " vertices processed";
+                if (isStreamed) std::cout << ", " << streamWriter.GetNumVerticesWritten() << " written to file";
+                std::cout << std::endl;
+            }
+        });
+
+        if (!desc.SuppressOutput && constants.analyticUnoccluded) std::cout << verticesUnoccluded
+            << " vertices had nothing above their tangent plane and used the closed form transfer" << std::endl;
+
+        if (isStreamed) {
+            if (isWritten && !streamWriter.Finish()) isWritten = false;
+        }
+        else {
+            if (!desc.SuppressOutput) std::cout << "Writing to file: " << outFile << std::endl;
+
+            PRTWriter outPRTFile;
+
+            outPRTFile.AddVertices((float*)vertexData, vertexNum * 3);
+            outPRTFile.AddCoefficients((int)desc.MaxL, &coefficients[0], coefficients.size());
+            outPRTFile.AddIndices((UINT32*)indexData, triangleNum * 3);
+
+            isWritten = outPRTFile.Write(outFile, false, desc.OutputFormat);
+        }
+
+        if (!isWritten) {
+            std::string warningMessage = "DxPRT: Unable to write to file " + outFile + ". Please provide a location" +
+                " that can be accessed\n.";
+            OutputDebugStringA(warningMessage.c_str());
+        }
+
+    }
+
+    void GeneratePRT(const std::string& meshFile, const std::string& outFile,
+        const PRT_DESC& desc) {
+
+        if (!desc.SuppressOutput) std::cout << "Reading file: " << meshFile << std::endl;
+
+        std::string warningMessage = "DxPRT: Unable to read mesh file: " + meshFile + ". Please use a valid file" +
+            " and check the README document to ensure that it is supported\n.";
+
+        if (IsPlyFile(meshFile)) {
+            PlyReader ply;
+            if (!ply.Load(meshFile)) {
+                OutputDebugStringA(warningMessage.c_str());
+                return;
+            }
+
+            GeneratePRT(ply.GetVertices(), ply.GetSizeVertices() / 3,
+                ply.GetIndices(), ply.GetSizeIndices() / 3, ply.GetNormals(),
+                outFile, desc);
+            return;
+        }
+
+        ObjReader obj;
+        if (!obj.Load(meshFile)) {
+            OutputDebugStringA(warningMessage.c_str());
+            return;
+        }
+
+        GeneratePRT(obj.GetVertices(), obj.GetSizeVertices() / 3,
+            obj.GetIndices(), obj.GetSizeIndices() / 3, obj.GetNormals(),
+            outFile, desc);
+
+    }
+
+}
@@ -0,0 +1,435 @@
+/*
+*
+* Implimentation of GeneratePRT_CPU_Utility.h
+*
+*
+* This file is part of the implimentation and is not intended for public
+* use.
+*
+*
+* Forms part of the DxPRT project
+*
+*
+*
+* Author: Shaun Bailey
+*
+* Date created: 16/10/2026
+*
+* Last Updated: 16/10/2026
+*
+*
+*
+* MIT License
+*
+* Copyright (c) 2021 Shaun Bailey
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*
+*/
+
+#include "DxPRT/GeneratePRT_CPU_Utility.h"
+#include "DxPRT/GenerateDesc.h"
+#include "DxPRT/SIMD.h"
+#include <algorithm>
+#include <cmath>
+#include <thread>
+
+using namespace DxPRT;
+
+namespace DxPRT_Utility {
+
+    static const float PI = 3.14159265f;
+    static const UINT64 SH_BLOCK_SIZE = 256; // number of directions passed to CalcSHDirections at once
+
+
+    PRTCPUConstantContainer InitializePRTCPUConstants(const DxPRT::PRT_DESC& desc,
+        const UINT64& triangleNum, const UINT64& vertexNum) {
+        PRTCPUConstantContainer constants = {};
+        constants.maxL = desc.MaxL;
+        constants.nCoefficients = (desc.MaxL + 1) * (desc.MaxL + 1);
+        constants.triangleNum = triangleNum;
+        constants.vertexNum = vertexNum;
+
+        UINT64 numEventsX; // not needed on the CPU, but the events are rounded to match the GPU
+        RoundInput(desc.NumEvents, desc.SHGridNum, constants.numEvents,
+            numEventsX, constants.shGridNum);
+
+        constants.numThreads = desc.NumThreads;
+        if (constants.numThreads == 0) constants.numThreads = std::thread::hardware_concurrency();
+        if (constants.numThreads == 0) constants.numThreads = 1; // hardware_concurrency may not be known
+
+        constants.packetTraversal = desc.PacketTraversal;
+        constants.wideBVH = desc.WideBVH;
+        constants.mortonBVH = desc.MortonBVH;
+        constants.analyticUnoccluded = desc.AnalyticUnoccluded;
+        constants.controlVariate = desc.ControlVariate;
+        constants.visibility = desc.Visibility;
+        constants.hemicubeResolution = Hemicube::RoundResolution(desc.HemicubeResolution);
+        constants.sampling = desc.Sampling;
+        constants.latticeGenerator = LatticeGenerator(constants.numEvents);
+        constants.seed = desc.Seed;
+        constants.cosineZonal = CalcCosineZonal(constants.maxL);
+
+        return constants;
+    }
+
+
+    void InitializePRTCPUDataContainer(PRTCPUDataContainer& dataContainer,
+        const PRTCPUConstantContainer& constants, const float* vertexData,
+        const UINT32* indexData, const float* normalData) {
+
+        if (constants.visibility == VISIBILITY_HEMICUBE) {
+            dataContainer.hemicubeTriangles.Build(vertexData, indexData, constants.triangleNum);
+        }
+        else {
+            BVHBuildSettings settings;
+            settings.numThreads = constants.numThreads;
+            settings.mortonPresort = constants.mortonBVH;
+            dataContainer.bvh.Build(vertexData, constants.vertexNum, indexData, constants.triangleNum, settings);
+            dataContainer.bvhStats = dataContainer.bvh.GetBuildStats();
+
+            if (constants.wideBVH) {
+                dataContainer.wideBVH.Build(dataContainer.bvh);
+                dataContainer.bvh = BVH(); // the binary BVH is no longer needed
+            }
+        }
+
+        dataContainer.pVertexData = vertexData;
+        dataContainer.pIndexData = indexData;
+        dataContainer.pNormalData = normalData;
+    }
+
+
+    void InitializeCPUThreadScratch(std::vector<CPUThreadScratch>& scratch,
+        const PRTCPUConstantContainer& constants) {
+
+        scratch.resize(constants.numThreads);
+        for (UINT64 iThread = 0; iThread < constants.numThreads; ++iThread) {
+            scratch[iThread].total.resize(constants.nCoefficients);
+            scratch[iThread].visibleX.resize(SH_BLOCK_SIZE);
+            scratch[iThread].visibleY.resize(SH_BLOCK_SIZE);
+            scratch[iThread].visibleZ.resize(SH_BLOCK_SIZE);
+            scratch[iThread].visibleWeight.resize(SH_BLOCK_SIZE);
+            scratch[iThread].shBlock.resize(constants.nCoefficients * SH_BLOCK_SIZE);
+            if (constants.visibility == VISIBILITY_HEMICUBE) {
+                scratch[iThread].hemicube.Initialize(constants.hemicubeResolution);
+            }
+        }
+    }
+
+
+    void InitializeCPURayData(CPURayData& rayData, const float* pVertex, const float* pNormal) {
+
+        float normalLength = sqrt(pNormal[0] * pNormal[0] + pNormal[1] * pNormal[1] +
+            pNormal[2] * pNormal[2]);
+        if (normalLength == 0.0f) normalLength = 1.0f;
+
+        for (int i = 0; i < 3; ++i) {
+            rayData.rayPos[i] = pVertex[i];
+            rayData.forward[i] = pNormal[i] / normalLength;
+        }
+
+        // same x-direction as used for the shaders, unless the normal points along z
+        rayData.xDir[0] = -rayData.forward[1];
+        rayData.xDir[1] = rayData.forward[0];
+        rayData.xDir[2] = 0.0f;
+        float xLength = sqrt(rayData.xDir[0] * rayData.xDir[0] + rayData.xDir[1] * rayData.xDir[1]);
+        if (xLength < 1.0e-6f) {
+            rayData.xDir[0] = 1.0f;
+            rayData.xDir[1] = 0.0f;
+        }
+        else {
+            rayData.xDir[0] /= xLength;
+            rayData.xDir[1] /= xLength;
+        }
+
+        // yDir = cross(xDir, forward)
+        rayData.yDir[0] = rayData.xDir[1] * rayData.forward[2] - rayData.xDir[2] * rayData.forward[1];
+        rayData.yDir[1] = rayData.xDir[2] * rayData.forward[0] - rayData.xDir[0] * rayData.forward[2];
+        rayData.yDir[2] = rayData.xDir[0] * rayData.forward[1] - rayData.xDir[1] * rayData.forward[0];
+    }
+
+
+    std::vector<double> CalcCosineZonal(const UINT64& maxL) {
+
+        // moments[k] is the integral of t^k * P_l(t) over [0, 1], starting from P_0 = 1 and P_1 = t.
+        // (l + 1) P_(l + 1) = (2l + 1) t P_l - l P_(l - 1) relates the moments of neighbouring l,
+        // where moment 2 of each l is needed and so moment k up to 2 + maxL - l
+        UINT64 momentNum = maxL + 4;
+        std::vector<double> previous(momentNum), current(momentNum), next(momentNum);
+        for (UINT64 k = 0; k < momentNum; ++k) {
+            previous[k] = 1.0 / double(k + 1);
+            current[k] = 1.0 / double(k + 2);
+        }
+
+        std::vector<double> zonal(maxL + 1);
+        zonal[0] = 8.0 * previous[2];
+        if (maxL > 0) zonal[1] = 8.0 * current[2];
+        for (UINT64 l = 1; l < maxL; ++l) {
+            for (UINT64 k = 0; k + l + 1 < momentNum; ++k) {
+                next[k] = (double(2 * l + 1) * current[k + 1] - double(l) * previous[k]) / double(l + 1);
+            }
+            std::swap(previous, current);
+            std::swap(current, next);
+            zonal[l + 1] = 8.0 * current[2];
+        }
+
+        return zonal;
+    }
+
+
+    // the closed form transfer of a vertex with nothing above its tangent plane, see CalcCosineZonal
+    static void UnoccludedTransfer(float* coefficients, CPUThreadScratch& scratch,
+        const PRTCPUConstantContainer& constants, const CPURayData& rayData) {
+
+        float* sh = &scratch.shBlock[0];
+        CalcSHDirection(constants.maxL, rayData.forward[0], rayData.forward[1], rayData.forward[2], sh);
+        for (UINT64 l = 0; l <= constants.maxL; ++l) {
+            for (UINT64 j = l * l; j < (l + 1) * (l + 1); ++j) {
+                coefficients[j] = float(constants.cosineZonal[l] * double(sh[j]));
+            }
+        }
+    }
+
+
+    // generates the cosine weighted direction of a single event in the frame of the vertex
+    static void GenerateDirection(const float& random1, const float& random2, const CPURayData& rayData,
+        float* rayDir, float& cosTheta) {
+
+        float theta = acos(sqrt(1.0f - random1));
+        float phi = random2 * (2.0f * PI);
+        cosTheta = cos(theta);
+        float sinTheta = sin(theta);
+
+        for (int i = 0; i < 3; ++i) {
+            rayDir[i] = sinTheta * cos(phi) * rayData.xDir[i] + sin(phi) * sinTheta * rayData.yDir[i]
+                + cosTheta * rayData.forward[i];
+        }
+    }
+
+
+    // adds the product of the spherical harmonics and the cosine factor of the block of rays stored
+    // in the scratch buffers, which are the unoccluded rays or the occluded rays for the control variate
+    static void AccumulateSH(CPUThreadScratch& scratch, const PRTCPUConstantContainer& constants,
+        const UINT64& visibleNum) {
+
+        if (visibleNum == 0) return;
+
+        const float* weight = &scratch.visibleWeight[0];
+        CalcSHDirections(constants.maxL, visibleNum, &scratch.visibleX[0], &scratch.visibleY[0],
+            &scratch.visibleZ[0], &scratch.shBlock[0]);
+
+        for (UINT64 j = 0; j < constants.nCoefficients; ++j) {
+            const float* sh = &scratch.shBlock[j * visibleNum];
+            float blockTotal = 0.0f;
+            for (UINT64 i = 0; i < visibleNum; ++i) {
+                blockTotal += sh[i] * weight[i];
+            }
+            scratch.total[j] += blockTotal;
+        }
+    }
+
+
+    // stores a ray to be summed, the spherical harmonics are evaluated once SH_BLOCK_SIZE rays
+    // are stored such that the buffers do not grow with the number of events
+    static void AddVisible(CPUThreadScratch& scratch, const PRTCPUConstantContainer& constants,
+        UINT64& visibleNum, const float* rayDir, const float& weight) {
+
+        scratch.visibleX[visibleNum] = rayDir[0];
+        scratch.visibleY[visibleNum] = rayDir[1];
+        scratch.visibleZ[visibleNum] = rayDir[2];
+        scratch.visibleWeight[visibleNum] = weight;
+        if (++visibleNum == SH_BLOCK_SIZE) {
+            AccumulateSH(scratch, constants, visibleNum);
+            visibleNum = 0;
+        }
+    }
+
+
+    // traces all of the events of a vertex as packets of rays with similar directions
+    static void IntegratePackets(CPUThreadScratch& scratch, const PRTCPUDataContainer& data,
+        const PRTCPUConstantContainer& constants, const CPURayData& rayData, const SampleScramble& scramble,
+        const RandomStream& stream) {
+
+        UINT64 count = constants.numEvents;
+        scratch.directionX.resize(count);
+        scratch.directionY.resize(count);
+        scratch.directionZ.resize(count);
+        scratch.cosTheta.resize(count);
+        scratch.sortedDirections.resize(3 * count);
+        scratch.cell.resize(count);
+        scratch.order.resize(count);
+        scratch.occluded.resize(count);
+
+        // the random numbers are mapped continuously onto the hemisphere, so cells in the
+        // unit square give groups of similar directions. Around SIMD_WIDTH rays are kept per cell
+        UINT32 cellNum = (UINT32)sqrt(double(count) / double(SIMD_WIDTH));
+        cellNum = (std::max)(1u, (std::min)(cellNum, 256u));
+
+        std::vector<UINT32>& cellStart = scratch.cellStart;
+        cellStart.assign(cellNum * cellNum + 1, 0);
+        for (UINT64 i = 0; i < count; ++i) {
+            float rayDir[3], random1, random2;
+            DrawSample(constants.sampling, i, count, constants.latticeGenerator, scramble,
+                stream, random1, random2);
+            GenerateDirection(random1, random2, rayData, rayDir, scratch.cosTheta[i]);
+            scratch.directionX[i] = rayDir[0];
+            scratch.directionY[i] = rayDir[1];
+            scratch.directionZ[i] = rayDir[2];
+
+            UINT32 cellX = (std::min)((UINT32)(random1 * cellNum), cellNum - 1);
+            UINT32 cellY = (std::min)((UINT32)(random2 * cellNum), cellNum - 1);
+            // alternate the direction of each row such that consecutive cells are neighbours
+            if (cellY % 2 == 1) cellX = cellNum - 1 - cellX;
+            scratch.cell[i] = cellY * cellNum + cellX;
+            ++cellStart[scratch.cell[i] + 1];
+        }
+
+        // counting sort of the events by cell
+        for (UINT32 i = 0; i < cellNum * cellNum; ++i) {
+            cellStart[i + 1] += cellStart[i];
+        }
+        for (UINT64 i = 0; i < count; ++i) {
+            scratch.order[cellStart[scratch.cell[i]]++] = (UINT32)i;
+        }
+
+        std::vector<float>& sorted = scratch.sortedDirections;
+        for (UINT64 i = 0; i < count; ++i) {
+            UINT32 iSample = scratch.order[i];
+            sorted[i] = scratch.directionX[iSample];
+            sorted[count + i] = scratch.directionY[iSample];
+            sorted[2 * count + i] = scratch.directionZ[iSample];
+        }
+
+        if (constants.wideBVH) {
+            data.wideBVH.OccludedPacket(rayData.rayPos, &sorted[0], &sorted[count], &sorted[2 * count],
+                count, &scratch.occluded[0]);
+        }
+        else {
+            data.bvh.OccludedPacket(rayData.rayPos, &sorted[0], &sorted[count], &sorted[2 * count],
+                count, &scratch.occluded[0]);
+        }
+
+        UINT64 visibleNum = 0;
+        for (UINT64 i = 0; i < count; ++i) {
+            if ((scratch.occluded[i] != 0) != constants.controlVariate) continue; // not summed
+            float rayDir[3] = { sorted[i], sorted[count + i], sorted[2 * count + i] };
+            AddVisible(scratch, constants, visibleNum, rayDir, scratch.cosTheta[scratch.order[i]]);
+        }
+
+        AccumulateSH(scratch, constants, visibleNum);
+    }
+
+
+    // rasterizes the mesh about the vertex, and then looks up the visibility of every event in the hemicube
+    static bool IntegrateHemicube(CPUThreadScratch& scratch, const PRTCPUDataContainer& data,
+        const PRTCPUConstantContainer& constants, const CPURayData& rayData, const SampleScramble& scramble,
+        const RandomStream& stream) {
+
+        Hemicube& hemicube = scratch.hemicube;
+        bool isDrawn = hemicube.Rasterize(data.hemicubeTriangles, rayData.rayPos, rayData.xDir, rayData.yDir,
+            rayData.forward);
+        if (!isDrawn && constants.analyticUnoccluded) return false;
+
+        UINT64 visibleNum = 0;
+        for (UINT64 iEvent = 0; iEvent < constants.numEvents; ++iEvent) {
+
+            float rayDir[3], cosTheta, random1, random2;
+            DrawSample(constants.sampling, iEvent, constants.numEvents, constants.latticeGenerator,
+                scramble, stream, random1, random2);
+            GenerateDirection(random1, random2, rayData, rayDir, cosTheta);
+
+            float localX = rayDir[0] * rayData.xDir[0] + rayDir[1] * rayData.xDir[1] + rayDir[2] * rayData.xDir[2];
+            float localY = rayDir[0] * rayData.yDir[0] + rayDir[1] * rayData.yDir[1] + rayDir[2] * rayData.yDir[2];
+            if (hemicube.Occluded(localX, localY, cosTheta) != constants.controlVariate) continue; // not summed
+
+            AddVisible(scratch, constants, visibleNum, rayDir, cosTheta);
+        }
+
+        AccumulateSH(scratch, constants, visibleNum);
+        return true;
+    }
+
+
+    bool IntegrateVertex(float* coefficients, CPUThreadScratch& scratch, const PRTCPUDataContainer& data,
+        const PRTCPUConstantContainer& constants, const CPURayData& rayData, const UINT64& iVertex) {
+
+        // no rays are needed if nothing above the tangent plane could be hit
+        if (constants.analyticUnoccluded && constants.visibility == VISIBILITY_RAY_TRACING) {
+            bool hasOccluders = constants.wideBVH ? data.wideBVH.HasOccluders(rayData.rayPos, rayData.forward) :
+                data.bvh.HasOccluders(rayData.rayPos, rayData.forward);
+            if (!hasOccluders) {
+                UnoccludedTransfer(coefficients, scratch, constants, rayData);
+                return true;
+            }
+        }
+
+        std::vector<double>& total = scratch.total;
+        total.assign(constants.nCoefficients, 0.0);
+
+        // each vertex has its own stream of random numbers and randomization of the quasi-Monte Carlo
+        // sequences, such that the result does not depend on the thread used
+        RandomStream stream = InitializeRandomStream(constants.seed, iVertex);
+        SampleScramble scramble = {};
+        if (constants.sampling != SAMPLING_PSEUDO_RANDOM) scramble = InitializeScramble(stream);
+
+        if (constants.visibility == VISIBILITY_HEMICUBE) {
+            if (!IntegrateHemicube(scratch, data, constants, rayData, scramble, stream)) {
+                UnoccludedTransfer(coefficients, scratch, constants, rayData);
+                return true;
+            }
+        }
+        else if (constants.packetTraversal) {
+            IntegratePackets(scratch, data, constants, rayData, scramble, stream);
+        }
+        else {
+            UINT64 visibleNum = 0;
+            for (UINT64 iEvent = 0; iEvent < constants.numEvents; ++iEvent) {
+
+                float rayDir[3], cosTheta, random1, random2;
+                DrawSample(constants.sampling, iEvent, constants.numEvents, constants.latticeGenerator,
+                    scramble, stream, random1, random2);
+                GenerateDirection(random1, random2, rayData, rayDir, cosTheta);
+
+                bool isOccluded = constants.wideBVH ? data.wideBVH.Occluded(rayData.rayPos, rayDir) :
+                    data.bvh.Occluded(rayData.rayPos, rayDir);
+                if (isOccluded != constants.controlVariate) continue; // not summed
+
+                AddVisible(scratch, constants, visibleNum, rayDir, cosTheta);
+            }
+
+            AccumulateSH(scratch, constants, visibleNum);
+        }
+
+        if (constants.controlVariate) {
+            // the occluded part is subtracted from the exact transfer of the unshadowed vertex
+            UnoccludedTransfer(coefficients, scratch, constants, rayData);
+            for (UINT64 j = 0; j < constants.nCoefficients; ++j) {
+                coefficients[j] = float(double(coefficients[j]) - total[j] / double(constants.numEvents) * 4.0);
+            }
+        }
+        else {
+            for (UINT64 j = 0; j < constants.nCoefficients; ++j) {
+                coefficients[j] = float(total[j] / double(constants.numEvents) * 4.0);
+            }
+        }
+        return false;
+    }
+
+}
\ No newline at end of file
@@ -66,6 +66,8 @@ namespace DxPRT_Utility {
 
         constants.numThreadGroups = constants.numEvents / (8 * 8);
 
+        constants.seed = desc.Seed;
+
         return constants;
 
     }
@@ -74,12 +76,11 @@ namespace DxPRT_Utility {
     void InitalizePRTDataContainer(PRTDataContainer& dataContainer,
         const PRTConstantContainer& constants, float* vertexData,
         UINT32* indexData, float* normalData, const UINT64& numVertex,
-        const UINT64& triangleNum) {
+        const UINT64& triangleNum, const std::shared_ptr<const SHTable>& shTable) {
 
-        dataContainer.shData.resize(constants.nCoefficients);
-        GenerateSHvector(constants.shGridNum, constants.maxL, dataContainer.shData);
+        dataContainer.shTable = SHTable::GetShared(constants.shGridNum, constants.maxL, shTable);
 
-        GenerateRandomVector(constants.numEvents, dataContainer.randomData);
+        GenerateRandomVector(constants.numEvents, dataContainer.randomData, constants.seed);
 
         dataContainer.pIndexData = indexData;
         dataContainer.pVertexData = vertexData;
@@ -149,7 +150,7 @@ namespace DxPRT_Utility {
         for (int i = 0; i < constants.nCoefficients; ++i) {
             resources.shRes[i].SetTex2D(DXGI_FORMAT_R32_FLOAT, (UINT) constants.shGridNum, (UINT) constants.shGridNum, 4);
             resources.shRes[i].SetState(D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE);
-            resources.shRes[i].InitializeWithData(device, commandList, &dataContainer.shData[i][0]);
+            resources.shRes[i].InitializeWithData(device, commandList, dataContainer.shTable->GetGrid(i));
         }
 
         commandList.Close();
@@ -162,7 +163,7 @@ namespace DxPRT_Utility {
     void CleanUpPRT(PRTDataContainer& data, PRTResourceContainer& resources,
         const PRTConstantContainer& constants) {
         data.randomData.clear();
-        data.shData.clear();
+        data.shTable.reset();
 
         resources.indexRes.ReleaseUpload();
         resources.planeRes.ReleaseUpload();
@@ -337,7 +338,7 @@ namespace DxPRT_Utility {
     }
 
 
-    void StorePRTResult(std::vector<float>& coefficients, const PRTResourceContainer& resources,
+    void StorePRTResult(float* coefficients, const PRTResourceContainer& resources,
         const PRTConstantContainer& constants) {
 
 
@@ -352,7 +353,7 @@ namespace DxPRT_Utility {
                 total += *(pReadbackBufferData + j * constants.numThreadGroups + k);
             }
 
-            coefficients.push_back(total / float(constants.numEvents) * 4.0f);
+            coefficients[j] = total / float(constants.numEvents) * 4.0f;
         }
         D3D12_RANGE emptyRange{ 0, 0 };
         resources.readbackRes.GetResource()->Unmap(0, &emptyRange);
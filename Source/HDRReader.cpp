@@ -39,41 +39,113 @@
 */
 
 #include "DxPRT/HDRReader.h"
+#include "DxPRT/MappedFile.h"
+#include "DxPRT/PRTBinary.h"
+#include "DxPRT/TextParsing.h"
+#include "DxPRT/ThreadPool.h"
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <thread>
 
 
 namespace DxPRT_Utility {
 
+	// images with fewer pixels than this are decoded on the calling thread
+	static const size_t HDR_PARALLEL_PIXEL_NUM = 1 << 18;
+
+	/*
+	* GetExponentTable: returns the factor 2^(exponent - 128) / 256 for each exponent byte, such
+	* that a channel c of a pixel is given by (c + 0.5) * table[exponent]
+	*/
+	static const float* GetExponentTable()
+	{
+		struct ExponentTable
+		{
+			float table[256];
+			ExponentTable()
+			{
+				for (int i = 0; i < 256; ++i) table[i] = ldexpf(1.0f, i - 136);
+			}
+		};
+		static const ExponentTable exponentTable;
+		return exponentTable.table;
+	}
+
 	HDRReader::HDRReader() {}
 
-	HDRReader::HDRReader(const std::string &fileString) 
+	HDRReader::HDRReader(const std::string &fileString, const bool &useCache) 
 	{
-		this->Load(fileString);
+		this->Load(fileString, useCache);
 	}
 
-	bool HDRReader::Load(const std::string &fileString) 
+	bool HDRReader::Load(const std::string &fileString, const bool &useCache) 
 	{
 
-		std::ifstream infile(fileString, std::ifstream::binary);
-		if (infile.fail()) return false;
+		// clear any previously loaded file
+		*this = HDRReader();
+
+		MappedFile file;
+		if (!file.Open(fileString)) return false;
+		const unsigned char* p = (const unsigned char*)file.GetData();
+		const unsigned char* end = p + file.GetSize();
+
+		// the cache is only used if it was created from a file with the same contents
+		std::string cacheString = fileString + ".cache";
+		UINT64 sourceSize = file.GetSize();
+		UINT64 sourceHash = 0;
+		if (useCache)
+		{
+			PRTChecksum checksum;
+			UpdatePRTChecksum(checksum, p, file.GetSize());
+			sourceHash = FinalizePRTChecksum(checksum);
+			if (this->LoadCache(cacheString, sourceSize, sourceHash))
+			{
+				isLoaded_ = true;
+				return true;
+			}
+		}
 
-		if (!this->ProcessHeader(infile)) return false;
+		if (!this->ProcessHeader(p, end)) return false;
 
-		std::vector<float> decodedData;
-		if (!this->DecodeByteCode(infile, decodedData)) return false;
+		// find the start of each scanline, which only requires the run lengths to be read
+		std::vector<const unsigned char*> scanlines(height_);
+		for (size_t iLine = 0; iLine < height_; ++iLine)
+		{
+			scanlines[iLine] = p;
+			if (!this->DecodeScanline(p, end, nullptr)) return false;
+		}
 
-		this->GenerateData(decodedData);
+		// the scanlines are then decoded in parallel, each into a small buffer of its thread and
+		// converted straight into its place in data_
+		data_.resize(width_ * height_ * 3ull);
+		ThreadPool threadPool(width_ * height_ < HDR_PARALLEL_PIXEL_NUM ? 1 : 0);
+		std::vector<std::vector<unsigned char>> scanlineBuffers(threadPool.GetNumThreads(),
+			std::vector<unsigned char>(width_ * 4ull));
 
-		infile.close();
+		threadPool.ParallelFor(height_, 0, [&](UINT64 iThread, UINT64 beginLine, UINT64 endLine) {
+			unsigned char* scanline = &scanlineBuffers[iThread][0];
+			for (UINT64 iLine = beginLine; iLine < endLine; ++iLine)
+			{
+				const unsigned char* pLine = scanlines[iLine];
+				this->DecodeScanline(pLine, end, scanline); // already checked above
+				this->ConvertScanline(scanline, &data_[iLine * width_ * 3ull]);
+			}
+		});
 
 		isLoaded_ = true;
 
+		// failing to write the cache only means that the file is decoded again next time
+		if (useCache) this->WriteCache(cacheString, sourceSize, sourceHash);
+
 		return true;
 	}
 
 
 	float* HDRReader::GetData() 
 	{
-		if (isLoaded_) return &data_[0];
+		if (isLoaded_ && cacheFile_) return (float*)(cacheFile_->GetData() + HDR_CACHE_HEADER_SIZE);
+		else if (isLoaded_) return &data_[0];
 		else
 		{
 			this->NotLoadedMessage();
@@ -84,7 +156,7 @@ namespace DxPRT_Utility {
 
 	size_t HDRReader::GetNPixels() const 
 	{
-		if (isLoaded_) return data_.size() / 3;
+		if (isLoaded_) return width_ * height_;
 		else
 		{
 			this->NotLoadedMessage();
@@ -114,130 +186,174 @@ namespace DxPRT_Utility {
 
 
 
-	bool HDRReader::ProcessHeader(std::ifstream& infile)
+	bool HDRReader::ProcessHeader(const unsigned char*& p, const unsigned char* end)
 	{
 
-		bool inHeader = true;
-		std::string s;
-
-		getline(infile, s);
+		const char* text = (const char*)p;
+		const char* textEnd = (const char*)end;
 
-		if (s.substr(0, 2) != "#?") return false; // indicates that this is a radiance file
+		const char* lineEnd = FindLineEnd(text, textEnd);
+		if (lineEnd - text < 2 || text[0] != '#' || text[1] != '?') return false; // indicates that this is a radiance file
+		text = NextLine(lineEnd, textEnd);
 
 		// find end of main header, all settings are ignored
-		while (inHeader) 
+		while (true)
 		{
-			getline(infile, s);
-			if (s == "") 
-			{
-				inHeader = false;
-			}
+			if (text == textEnd) return false;
+			lineEnd = FindLineEnd(text, textEnd);
+			bool isEmpty = IsTextLineEnd(text, lineEnd);
+			text = NextLine(lineEnd, textEnd);
+			if (isEmpty) break;
 		}
 
 		// get width and height
 		// current itteration only accepts -Y N +X M
-		getline(infile, s);
-		std::istringstream ss(s);
-
-		getline(ss, s, ' ');
-		if (s != "-Y") return false;
-		getline(ss, s, ' ');
-		height_ = std::stoi(s);
+		lineEnd = FindLineEnd(text, textEnd);
+		const char* token = SkipTextSpaces(text, lineEnd);
+		const char* tokenEnd = FindTokenEnd(token, lineEnd);
+		if (std::string(token, tokenEnd) != "-Y") return false;
+		tokenEnd = ParseTextValue(SkipTextSpaces(tokenEnd, lineEnd), lineEnd, height_);
+		if (!tokenEnd) return false;
+
+		token = SkipTextSpaces(tokenEnd, lineEnd);
+		tokenEnd = FindTokenEnd(token, lineEnd);
+		if (std::string(token, tokenEnd) != "+X") return false;
+		tokenEnd = ParseTextValue(SkipTextSpaces(tokenEnd, lineEnd), lineEnd, width_);
+		if (!tokenEnd) return false;
+
+		// the width of a run-length encoded scanline is stored in 15 bits, and each scanline
+		// takes at least 4 bytes
+		text = NextLine(lineEnd, textEnd);
+		if (width_ == 0 || width_ > 0x7fff) return false;
+		if (height_ == 0 || height_ > (size_t)(textEnd - text) / 4) return false;
+
+		p = (const unsigned char*)text;
+		return true;
+	}
 
-		getline(ss, s, ' ');
-		if (s != "+X") return false;
-		getline(ss, s, ' ');
-		width_ = std::stoi(s);
+	bool HDRReader::LoadCache(const std::string &cacheString, const UINT64 &sourceSize,
+		const UINT64 &sourceHash)
+	{
 
+		std::shared_ptr<MappedFile> file = std::make_shared<MappedFile>();
+		if (!file->Open(cacheString)) return false;
+		if (file->GetSize() < HDR_CACHE_HEADER_SIZE) return false;
+
+		HDRCacheHeader header;
+		memcpy(&header, file->GetData(), sizeof(header));
+		if (memcmp(header.magic, HDR_CACHE_MAGIC, sizeof(HDR_CACHE_MAGIC)) != 0) return false;
+		if (header.version != HDR_CACHE_VERSION || header.pixelSize != 3 * sizeof(float)) return false;
+		if (header.sourceSize != sourceSize || header.sourceHash != sourceHash) return false;
+
+		// the same limits as the hdr file, which also guard against overflow below
+		if (header.width == 0 || header.width > 0x7fff) return false;
+		if (header.height == 0 || header.height > sourceSize / 4) return false;
+		if (header.dataOffset != HDR_CACHE_HEADER_SIZE) return false;
+		if (header.fileSize != file->GetSize() ||
+			header.fileSize != header.dataOffset + header.width * header.height * header.pixelSize) return false;
+
+		width_ = (size_t)header.width;
+		height_ = (size_t)header.height;
+		cacheFile_ = file;
 		return true;
 	}
 
-	bool HDRReader::DecodeByteCode(std::ifstream& infile,
-		std::vector<float>& decodedData) const
+
+	bool HDRReader::WriteCache(const std::string &cacheString, const UINT64 &sourceSize,
+		const UINT64 &sourceHash) const
 	{
 
-		auto startPos = infile.tellg(); // get position in data
-		infile.seekg(0, std::ios::end);
-		auto endPos = infile.tellg();
-		auto byteSize = endPos - startPos;
-		infile.seekg(startPos);
+		HDRCacheHeader header = {};
+		memcpy(header.magic, HDR_CACHE_MAGIC, sizeof(header.magic));
+		header.version = HDR_CACHE_VERSION;
+		header.pixelSize = 3 * sizeof(float);
+		header.width = width_;
+		header.height = height_;
+		header.dataOffset = HDR_CACHE_HEADER_SIZE;
+		header.fileSize = header.dataOffset + width_ * height_ * header.pixelSize;
+		header.sourceSize = sourceSize;
+		header.sourceHash = sourceHash;
+
+		// the temporary name is unique to the thread, as several threads may load the same file
+		std::string tempString = cacheString + "." +
+			std::to_string(std::hash<std::thread::id>()(std::this_thread::get_id())) + ".tmp";
+
+		std::ofstream file(tempString, std::ofstream::binary);
+		if (!file.is_open()) return false;
+		file.write((const char*)&header, sizeof(header));
+		file.write((const char*)&data_[0], width_ * height_ * header.pixelSize);
+		file.close();
+
+		if (file.fail())
+		{
+			std::remove(tempString.c_str());
+			return false;
+		}
+
+		// rename does not replace an existing file on windows, which fails to be removed if it is
+		// still mapped by another reader
+		bool isRenamed = std::rename(tempString.c_str(), cacheString.c_str()) == 0;
+		if (!isRenamed)
+		{
+			std::remove(cacheString.c_str());
+			isRenamed = std::rename(tempString.c_str(), cacheString.c_str()) == 0;
+		}
+		if (!isRenamed) std::remove(tempString.c_str());
+		return isRenamed;
+	}
 
-		std::vector<unsigned char> byteData(byteSize, 0);
 
-		infile.read((char*)&byteData[0], byteSize);
-		auto iter = byteData.cbegin();
-		auto iterEnd = byteData.cend();
+	bool HDRReader::DecodeScanline(const unsigned char*& p, const unsigned char* end,
+		unsigned char* scanline) const
+	{
 
-		decodedData.resize(width_ * height_ * 4ull);
-		int index = 0;
+		// each scanline starts with 2, 2 and then its width
+		if (end - p < 4) return false;
+		if (p[0] != 2 || p[1] != 2 || (((size_t)p[2] << 8) | p[3]) != width_) return false;
+		p += 4;
 
-		// loop over data
-		for (unsigned int iLine = 0; iLine < height_; ++iLine) 
+		size_t iData = 0;
+		while (iData < width_ * 4) 
 		{
-			iter += 4; // skip first 4 bytes
-			unsigned int iData = 0;
+			if (p == end) return false; //bad scanline data
+			size_t counter = *p;
+			++p;
 
-			while (iData < width_ * 4) 
+			if (counter > 128) // run of the same number
+			{
+				counter -= 128;
+				if (p == end || counter > width_ * 4 - iData) return false; //bad scanline data
+				if (scanline) memset(scanline + iData, *p, counter);
+				++p;
+			}
+			else // run of different numbers
 			{
-				unsigned int counter = (unsigned int)(*iter);
-
-				
-				if (counter > 128) // run of the same number
-				{
-					counter -= 128;
-					if (iterEnd - iter < 2) {
-						return false; //bad scanline data
-					}
-					++iter;
-					for (unsigned int i = 0; i < counter; ++i) {
-						decodedData[index] = (float)(*iter);
-						++index;
-					}
-				}
-				else // run of different numbers
-				{
-					if (iterEnd - iter < counter + 1ull) {
-						return false; //bad scanline data
-					}
-					for (unsigned int i = 0; i < counter; ++i) {
-						decodedData[index] = (float)(*(++iter));
-						++index;
-					}
-				}
-				++iter;
-
-				
-				if (width_ * 4 - iData < counter) // ensure that there is enough bytes left for this line
-				{
-					return false; //bad scanline data
-				}
-
-				iData += counter;
+				if ((size_t)(end - p) < counter || counter > width_ * 4 - iData) return false; //bad scanline data
+				if (scanline) memcpy(scanline + iData, p, counter);
+				p += counter;
 			}
+
+			iData += counter;
 		}
 
 		return true;
 	}
 
 
-	void HDRReader::GenerateData(const std::vector<float>& decodedData)
+	void HDRReader::ConvertScanline(const unsigned char* scanline, float* pixels) const
 	{
-		data_.resize(width_ * height_ * 3ull);
-		for (size_t i = 0; i < height_; ++i) 
-		{
-			for (size_t j = 0; j < width_; ++j) 
-			{
-				float red = (float)(decodedData[width_ * 4ull * i + j]);
-				float green = (float)(decodedData[width_ * (4ull * i + 1ull) + j]);
-				float blue = (float)(decodedData[width_ * (4ull * i + 2ull) + j]);
-				float exp = (float)(decodedData[width_ * (4ull * i + 3ull) + j]);
-
-
-				data_[(i * width_ + j) * 3ull] = (red + 0.5f) * powf(2.0f, exp - 128.0f) / 256.0f;
-				data_[(i * width_ + j) * 3ull + 1ull] = (green + 0.5f) * powf(2.0f, exp - 128.0f) / 256.0f;
-				data_[(i * width_ + j) * 3ull + 2ull] = (blue + 0.5f) * powf(2.0f, exp - 128.0f) / 256.0f;
+		const float* exponentTable = GetExponentTable();
+		const unsigned char* red = scanline;
+		const unsigned char* green = scanline + width_;
+		const unsigned char* blue = scanline + width_ * 2;
+		const unsigned char* exponent = scanline + width_ * 3;
 
-			}
+		for (size_t j = 0; j < width_; ++j) 
+		{
+			float scale = exponentTable[exponent[j]];
+			pixels[j * 3ull] = ((float)red[j] + 0.5f) * scale;
+			pixels[j * 3ull + 1ull] = ((float)green[j] + 0.5f) * scale;
+			pixels[j * 3ull + 2ull] = ((float)blue[j] + 0.5f) * scale;
 		}
 	}
 
@@ -0,0 +1,422 @@
+/*
+*
+* Implimentation of Hemicube.h
+*
+*
+* This file is part of the implimentation and is not intended for public
+* use.
+*
+*
+* Forms part of the DxPRT project
+*
+*
+*
+* Author: Shaun Bailey
+*
+* Date created: 16/10/2026
+*
+* Last Updated: 16/10/2026
+*
+*
+*
+* MIT License
+*
+* Copyright (c) 2021 Shaun Bailey
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*
+*/
+
+#include "DxPRT/Hemicube.h"
+#include "DxPRT/SIMD.h"
+#include <algorithm>
+#include <cmath>
+
+
+namespace DxPRT_Utility {
+
+	static const UINT32 TILE_SIZE = 8; // pixels along each edge of a tile, such that a tile is 64 bits
+	static const int MAX_POLYGON_SIZE = 7; // a triangle clipped by the 4 planes of a face
+	static const UINT64 FULL_TILE = ~0ull;
+
+
+	// the faces of the hemicube, the direction (x, y, z) in the frame of the vertex lies on
+	// a face if sign * (axis component) is the largest. The pixel coordinates on the face are
+	// given by the components u and v divided by this
+	struct HemicubeFace
+	{
+		int axis;
+		float sign;
+		int u;
+		int v;
+	};
+
+	static const HemicubeFace FACES[5] = {
+		{ 2, 1.0f, 0, 1 }, // top, along the normal
+		{ 0, 1.0f, 1, 2 },
+		{ 0, -1.0f, 1, 2 },
+		{ 1, 1.0f, 0, 2 },
+		{ 1, -1.0f, 0, 2 }
+	};
+
+
+	/*
+	* ClipPolygon: clips a polygon to the half-space where the component a of each point plus
+	* sign times the component c is positive. The planes pass through the vertex, such that the
+	* points are clipped in the same way as homogeneous coordinates
+	*
+	* _IN_ in: the points of the polygon, each given as (a, u, v)
+	* _IN_ inNum: the number of points
+	* _IN_ c: the component compared against a, 1 for u and 2 for v
+	* _IN_ sign: either 1 or -1
+	* _OUT_ out: the points of the clipped polygon
+	* returns the number of points of the clipped polygon
+	*/
+	static int ClipPolygon(const float in[][3], const int& inNum, const int& c, const float& sign,
+		float out[][3])
+	{
+		int outNum = 0;
+		for (int i = 0; i < inNum; ++i)
+		{
+			const float* p0 = in[i];
+			const float* p1 = in[(i + 1) % inNum];
+			float d0 = p0[0] + sign * p0[c];
+			float d1 = p1[0] + sign * p1[c];
+
+			if (d0 >= 0.0f)
+			{
+				std::copy(p0, p0 + 3, out[outNum++]);
+			}
+			if ((d0 >= 0.0f) != (d1 >= 0.0f))
+			{
+				float t = d0 / (d0 - d1);
+				for (int k = 0; k < 3; ++k)
+				{
+					out[outNum][k] = p0[k] + t * (p1[k] - p0[k]);
+				}
+				++outNum;
+			}
+		}
+		return outNum;
+	}
+
+
+	void HemicubeTriangles::Build(const float* vertexData, const UINT32* indexData, const UINT64& triangleNum)
+	{
+		this->triangleNum = triangleNum;
+		stride = (triangleNum + SIMD_WIDTH - 1) / SIMD_WIDTH * SIMD_WIDTH;
+		vertices.assign(9 * stride, 0.0f);
+		for (UINT64 i = 0; i < triangleNum; ++i)
+		{
+			for (int j = 0; j < 3; ++j)
+			{
+				const float* vertex = vertexData + 3ull * indexData[3 * i + j];
+				for (int k = 0; k < 3; ++k)
+				{
+					vertices[(3 * j + k) * stride + i] = vertex[k];
+				}
+			}
+		}
+	}
+
+
+	Hemicube::Hemicube() {}
+
+
+	void Hemicube::Initialize(const UINT64& resolution)
+	{
+		resolution_ = RoundResolution(resolution);
+		tilesX_ = resolution_ / TILE_SIZE;
+
+		UINT64 topTiles = tilesX_ * tilesX_;
+		UINT64 sideTiles = tilesX_ * tilesX_ / 2;
+		faceOffset_[0] = 0;
+		for (int face = 1; face < 5; ++face)
+		{
+			faceOffset_[face] = topTiles + (face - 1) * sideTiles;
+		}
+		tiles_.assign(topTiles + 4 * sideTiles, 0);
+	}
+
+
+	bool Hemicube::Rasterize(const HemicubeTriangles& triangles, const float* origin, const float* xDir,
+		const float* yDir, const float* forward)
+	{
+		std::fill(tiles_.begin(), tiles_.end(), 0);
+		bool isDrawn = false;
+
+		const float* frame[3] = { xDir, yDir, forward };
+		SIMDFloat zero = SIMDSet(0.0f);
+
+		for (UINT64 begin = 0; begin < triangles.triangleNum; begin += SIMD_WIDTH)
+		{
+			// transform SIMD_WIDTH triangles into the frame of the vertex
+			SIMDFloat local[3][3], relative[3][3];
+			UINT32 atOrigin = 0, belowMask = SIMDLaneMask(SIMD_WIDTH);
+			for (int j = 0; j < 3; ++j)
+			{
+				for (int k = 0; k < 3; ++k)
+				{
+					relative[j][k] = SIMDLoad(&triangles.vertices[(3 * j + k) * triangles.stride + begin]) -
+						SIMDSet(origin[k]);
+				}
+				for (int i = 0; i < 3; ++i)
+				{
+					local[j][i] = relative[j][0] * SIMDSet(frame[i][0]) + relative[j][1] * SIMDSet(frame[i][1]) +
+						relative[j][2] * SIMDSet(frame[i][2]);
+				}
+				atOrigin |= SIMDLessEqual(relative[j][0] * relative[j][0] + relative[j][1] * relative[j][1] +
+					relative[j][2] * relative[j][2], zero);
+				belowMask &= SIMDLessEqual(local[j][2], zero);
+			}
+
+			// the ray tracers only hit the front of a triangle, where the triple product of the
+			// vectors to its vertices is negative, so the back faces are culled in the same way
+			const SIMDFloat* a = relative[0];
+			const SIMDFloat* b = relative[1];
+			SIMDFloat tripleProduct = (a[1] * b[2] - a[2] * b[1]) * relative[2][0] +
+				(a[2] * b[0] - a[0] * b[2]) * relative[2][1] + (a[0] * b[1] - a[1] * b[0]) * relative[2][2];
+			UINT32 backMask = ~SIMDLess(tripleProduct, zero) & SIMDLaneMask(SIMD_WIDTH);
+
+			// triangles below the tangent plane cannot occlude any direction of the hemisphere
+			UINT32 count = (UINT32)(std::min)((UINT64)SIMD_WIDTH, triangles.triangleNum - begin);
+			UINT32 acceptMask = SIMDLaneMask(count) & ~belowMask & ~atOrigin & ~backMask;
+			if (acceptMask == 0) continue;
+			isDrawn = true;
+
+			float lanes[3][3][SIMD_WIDTH];
+			for (int j = 0; j < 3; ++j)
+			{
+				for (int i = 0; i < 3; ++i)
+				{
+					SIMDStore(lanes[j][i], local[j][i]);
+				}
+			}
+
+			for (UINT32 lane = 0; lane < SIMD_WIDTH; ++lane)
+			{
+				if (!((acceptMask >> lane) & 1u)) continue;
+				float vertices[3][3];
+				for (int j = 0; j < 3; ++j)
+				{
+					for (int i = 0; i < 3; ++i)
+					{
+						vertices[j][i] = lanes[j][i][lane];
+					}
+				}
+				this->DrawTriangle(vertices);
+			}
+		}
+
+		return isDrawn;
+	}
+
+
+	bool Hemicube::Occluded(const float& x, const float& y, const float& z) const
+	{
+		float absX = std::fabs(x), absY = std::fabs(y);
+		float halfResolution = 0.5f * float(resolution_);
+
+		int face;
+		float u, v;
+		if (z >= absX && z >= absY)
+		{
+			face = 0;
+			u = x / z;
+			v = y / z + 1.0f; // the top face spans [-1, 1] in both directions
+		}
+		else if (absX >= absY)
+		{
+			face = x > 0.0f ? 1 : 2;
+			u = y / absX;
+			v = z / absX;
+		}
+		else
+		{
+			face = y > 0.0f ? 3 : 4;
+			u = x / absY;
+			v = z / absY;
+		}
+
+		UINT64 height = face == 0 ? resolution_ : resolution_ / 2;
+		UINT64 i = (UINT64)(std::min)((std::max)((u + 1.0f) * halfResolution, 0.0f), float(resolution_ - 1));
+		UINT64 j = (UINT64)(std::min)((std::max)(v * halfResolution, 0.0f), float(height - 1));
+
+		UINT64 tile = tiles_[faceOffset_[face] + (j / TILE_SIZE) * tilesX_ + i / TILE_SIZE];
+		return (tile >> ((j % TILE_SIZE) * TILE_SIZE + i % TILE_SIZE)) & 1ull;
+	}
+
+
+	UINT64 Hemicube::GetResolution() const
+	{
+		return resolution_;
+	}
+
+
+	UINT64 Hemicube::RoundResolution(const UINT64& resolution)
+	{
+		return (std::max)((resolution + 15) / 16 * 16, (UINT64)16);
+	}
+
+
+	void Hemicube::DrawTriangle(const float vertices[3][3])
+	{
+		float halfResolution = 0.5f * float(resolution_);
+
+		for (int face = 0; face < 5; ++face)
+		{
+			const HemicubeFace& faceDesc = FACES[face];
+
+			float polygon[2][MAX_POLYGON_SIZE][3];
+			int isOutside[4] = { 1, 1, 1, 1 };
+			bool isBelow = true;
+			for (int j = 0; j < 3; ++j)
+			{
+				float a = faceDesc.sign * vertices[j][faceDesc.axis];
+				float u = vertices[j][faceDesc.u], v = vertices[j][faceDesc.v];
+				polygon[0][j][0] = a;
+				polygon[0][j][1] = u;
+				polygon[0][j][2] = v;
+				isOutside[0] &= a - u < 0.0f;
+				isOutside[1] &= a + u < 0.0f;
+				isOutside[2] &= a - v < 0.0f;
+				isOutside[3] &= a + v < 0.0f;
+				isBelow &= v <= 0.0f;
+			}
+
+			// skip the face if the triangle is outside of one of its planes, or only covers the
+			// lower half of a side face
+			if (isOutside[0] | isOutside[1] | isOutside[2] | isOutside[3]) continue;
+			if (face != 0 && isBelow) continue;
+
+			// clip to the frustum of the face, ping-ponging between the two polygons
+			int pointNum = 3, current = 0;
+			const int planes[4][2] = { { 1, -1 }, { 1, 1 }, { 2, -1 }, { 2, 1 } };
+			for (int iPlane = 0; iPlane < 4 && pointNum >= 3; ++iPlane)
+			{
+				pointNum = ClipPolygon(polygon[current], pointNum, planes[iPlane][0], float(planes[iPlane][1]),
+					polygon[1 - current]);
+				current = 1 - current;
+			}
+			if (pointNum < 3) continue;
+
+			float points[MAX_POLYGON_SIZE][2];
+			bool isValid = true;
+			for (int j = 0; j < pointNum; ++j)
+			{
+				const float* p = polygon[current][j];
+				if (!(p[0] > 0.0f))
+				{
+					isValid = false; // only possible if the triangle passes through the vertex
+					break;
+				}
+				points[j][0] = (p[1] / p[0] + 1.0f) * halfResolution;
+				points[j][1] = (p[2] / p[0] + (face == 0 ? 1.0f : 0.0f)) * halfResolution;
+			}
+			if (isValid) this->DrawPolygon(face, points, pointNum);
+		}
+	}
+
+
+	void Hemicube::DrawPolygon(const int& face, const float points[][2], const int& pointNum)
+	{
+		UINT64 height = face == 0 ? resolution_ : resolution_ / 2;
+
+		// edge functions A * x + B * y + C, positive inside of the polygon
+		float area = 0.0f;
+		for (int i = 0; i < pointNum; ++i)
+		{
+			const float* p0 = points[i];
+			const float* p1 = points[(i + 1) % pointNum];
+			area += p0[0] * p1[1] - p1[0] * p0[1];
+		}
+		if (area == 0.0f) return;
+		float orientation = area > 0.0f ? 1.0f : -1.0f;
+
+		float A[MAX_POLYGON_SIZE], B[MAX_POLYGON_SIZE], C[MAX_POLYGON_SIZE];
+		float minX = points[0][0], maxX = points[0][0], minY = points[0][1], maxY = points[0][1];
+		for (int i = 0; i < pointNum; ++i)
+		{
+			const float* p0 = points[i];
+			const float* p1 = points[(i + 1) % pointNum];
+			A[i] = -orientation * (p1[1] - p0[1]);
+			B[i] = orientation * (p1[0] - p0[0]);
+			C[i] = -(A[i] * p0[0] + B[i] * p0[1]);
+			minX = (std::min)(minX, p0[0]);
+			maxX = (std::max)(maxX, p0[0]);
+			minY = (std::min)(minY, p0[1]);
+			maxY = (std::max)(maxY, p0[1]);
+		}
+
+		// the pixels whose centres lie within the bounds of the polygon
+		INT64 i0 = (std::max)((INT64)std::ceil(minX - 0.5f), (INT64)0);
+		INT64 i1 = (std::min)((INT64)std::floor(maxX - 0.5f), (INT64)resolution_ - 1);
+		INT64 j0 = (std::max)((INT64)std::ceil(minY - 0.5f), (INT64)0);
+		INT64 j1 = (std::min)((INT64)std::floor(maxY - 0.5f), (INT64)height - 1);
+		if (i0 > i1 || j0 > j1) return;
+
+		static const float LANE_OFFSETS[TILE_SIZE] = { 0.0f, 1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f, 7.0f };
+		SIMDFloat8 laneOffsets = SIMD8Load(LANE_OFFSETS);
+		SIMDFloat8 zero = SIMD8Set(0.0f);
+
+		for (INT64 tileY = j0 / TILE_SIZE; tileY <= j1 / TILE_SIZE; ++tileY)
+		{
+			for (INT64 tileX = i0 / TILE_SIZE; tileX <= i1 / TILE_SIZE; ++tileX)
+			{
+				UINT64& tile = tiles_[faceOffset_[face] + tileY * tilesX_ + tileX];
+				if (tile == FULL_TILE) continue;
+
+				// the edge functions are linear, so their range over the tile is found from the
+				// pixel centres at its corners
+				float x0 = float(tileX * TILE_SIZE) + 0.5f, y0 = float(tileY * TILE_SIZE) + 0.5f;
+				float x1 = x0 + float(TILE_SIZE - 1), y1 = y0 + float(TILE_SIZE - 1);
+				bool isFull = true, isEmpty = false;
+				for (int i = 0; i < pointNum && !isEmpty; ++i)
+				{
+					float e00 = A[i] * x0 + B[i] * y0 + C[i], e10 = A[i] * x1 + B[i] * y0 + C[i];
+					float e01 = A[i] * x0 + B[i] * y1 + C[i], e11 = A[i] * x1 + B[i] * y1 + C[i];
+					isEmpty = (std::max)((std::max)(e00, e10), (std::max)(e01, e11)) < 0.0f;
+					isFull &= (std::min)((std::min)(e00, e10), (std::min)(e01, e11)) >= 0.0f;
+				}
+				if (isEmpty) continue;
+				if (isFull)
+				{
+					tile = FULL_TILE;
+					continue;
+				}
+
+				// test each row of 8 pixels at once
+				SIMDFloat8 x = SIMD8Set(x0) + laneOffsets;
+				UINT64 mask = 0;
+				for (UINT32 row = 0; row < TILE_SIZE; ++row)
+				{
+					float y = y0 + float(row);
+					UINT32 outside = 0;
+					for (int i = 0; i < pointNum; ++i)
+					{
+						outside |= SIMD8Less(SIMD8Set(A[i]) * x + SIMD8Set(B[i] * y + C[i]), zero);
+					}
+					mask |= UINT64(~outside & 0xffu) << (row * TILE_SIZE);
+				}
+				tile |= mask;
+			}
+		}
+	}
+
+}
@@ -0,0 +1,167 @@
+/*
+*
+* Implimentation of the MappedFile Class (see MappedFile.h)
+*
+*
+* Forms part of the DxPRT project
+*
+*
+*
+* Author: Shaun Bailey
+*
+* Date created: 16/10/2026
+*
+* Last Updated: 16/10/2026
+*
+*
+*
+* MIT License
+*
+* Copyright (c) 2021 Shaun Bailey
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*
+*/
+
+#include "DxPRT/MappedFile.h"
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+
+namespace DxPRT_Utility {
+
+	MappedFile::MappedFile() {}
+
+	MappedFile::~MappedFile()
+	{
+		this->Close();
+	}
+
+
+#ifdef _WIN32
+
+	bool MappedFile::Open(const std::string& fileName)
+	{
+		this->Close();
+
+		file_ = CreateFileA(fileName.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+			FILE_ATTRIBUTE_NORMAL, nullptr);
+		if (file_ == INVALID_HANDLE_VALUE) return false;
+
+		LARGE_INTEGER fileSize;
+		if (!GetFileSizeEx(file_, &fileSize) || fileSize.QuadPart == 0)
+		{
+			this->Close();
+			return false;
+		}
+
+		mapping_ = CreateFileMappingA(file_, nullptr, PAGE_WRITECOPY, 0, 0, nullptr);
+		if (mapping_ == nullptr)
+		{
+			this->Close();
+			return false;
+		}
+
+		data_ = (char*)MapViewOfFile(mapping_, FILE_MAP_COPY, 0, 0, 0);
+		if (data_ == nullptr)
+		{
+			this->Close();
+			return false;
+		}
+
+		size_ = (size_t)fileSize.QuadPart;
+		return true;
+	}
+
+
+	void MappedFile::Close()
+	{
+		if (data_ != nullptr) UnmapViewOfFile(data_);
+		if (mapping_ != nullptr) CloseHandle(mapping_);
+		if (file_ != INVALID_HANDLE_VALUE) CloseHandle(file_);
+
+		data_ = nullptr;
+		mapping_ = nullptr;
+		file_ = INVALID_HANDLE_VALUE;
+		size_ = 0;
+	}
+
+#else
+
+	bool MappedFile::Open(const std::string& fileName)
+	{
+		this->Close();
+
+		file_ = open(fileName.c_str(), O_RDONLY);
+		if (file_ < 0) return false;
+
+		struct stat fileStat;
+		if (fstat(file_, &fileStat) != 0 || fileStat.st_size == 0)
+		{
+			this->Close();
+			return false;
+		}
+
+		void* data = mmap(nullptr, (size_t)fileStat.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, file_, 0);
+		if (data == MAP_FAILED)
+		{
+			this->Close();
+			return false;
+		}
+
+		data_ = (char*)data;
+		size_ = (size_t)fileStat.st_size;
+		return true;
+	}
+
+
+	void MappedFile::Close()
+	{
+		if (data_ != nullptr) munmap(data_, size_);
+		if (file_ >= 0) close(file_);
+
+		data_ = nullptr;
+		file_ = -1;
+		size_ = 0;
+	}
+
+#endif
+
+
+	char* MappedFile::GetData() const
+	{
+		return data_;
+	}
+
+	size_t MappedFile::GetSize() const
+	{
+		return size_;
+	}
+
+	bool MappedFile::IsOpen() const
+	{
+		return data_ != nullptr;
+	}
+
+}
@@ -39,10 +39,48 @@
 */
 
 #include "DxPRT/ObjReader.h"
+#include "DxPRT/MappedFile.h"
+#include "DxPRT/TextParsing.h"
+#include "DxPRT/ThreadPool.h"
+#include <atomic>
 
 
 namespace DxPRT_Utility {
 
+	void SumFaceNormals(const float* vertices, const UINT32* indices, const size_t& triangleNum,
+		float* normals)
+	{
+		for (size_t iFace = 0; iFace < triangleNum; ++iFace)
+		{
+			const UINT32* face = &indices[iFace * 3];
+			float vector1[3], vector2[3], normal[3];
+
+			for (int i = 0; i < 3; ++i) {
+				vector1[i] = vertices[(size_t)face[1] * 3 + i] -
+					vertices[(size_t)face[0] * 3 + i];
+				vector2[i] = vertices[(size_t)face[2] * 3 + i] -
+					vertices[(size_t)face[0] * 3 + i];
+			}
+
+			normal[0] = vector1[1] * vector2[2] -
+				vector1[2] * vector2[1];
+			normal[1] = vector1[2] * vector2[0] -
+				vector1[0] * vector2[2];
+			normal[2] = vector1[0] * vector2[1] -
+				vector1[1] * vector2[0];
+
+			for (int iVertex = 0; iVertex < 3; ++iVertex) 
+			{
+				for (int iIndex = 0; iIndex < 3; ++iIndex) 
+				{
+					normals[(size_t)face[iIndex] * 3 + iVertex]
+						+= normal[iVertex];
+				}
+			}
+		}
+	}
+
+
 	ObjReader::ObjReader(const std::string &fileName, const bool &calculateNormals) {
 		this->Load(fileName, calculateNormals);
 	}
@@ -52,137 +90,287 @@ namespace DxPRT_Utility {
 
 	bool ObjReader::Load(const std::string &fileName, const bool &calculateNormals)
 	{
-		std::ifstream infile(fileName);
-
+		// clear any previously loaded file
+		*this = ObjReader();
 		calcNormals_ = calculateNormals;
 
-		while (infile)
+		MappedFile file;
+		if (!file.Open(fileName)) return false;
+
+		// small files are parsed on the calling thread
+		ThreadPool threadPool(file.GetSize() < TEXT_CHUNK_SIZE ? 1 : 0);
+		std::vector<const char*> chunkBounds = SplitTextLines(file.GetData(), file.GetSize(),
+			threadPool.GetNumThreads());
+		std::vector<Chunk> chunks(chunkBounds.size() - 1);
+		for (size_t i = 0; i < chunks.size(); ++i)
 		{
-			std::string s;
-			if (!getline(infile, s)) break;
+			chunks[i].begin = chunkBounds[i];
+			chunks[i].end = chunkBounds[i + 1];
+		}
 
-			if (s[0] != '#' && s != "") // ignore comments and empty lines
-			{
-				std::istringstream ss(s);
-				std::vector<std::string> stringVec;
+		// count the elements first, such that the vectors are allocated once and each chunk is
+		// parsed directly into its place
+		threadPool.ParallelFor(chunks.size(), 1, [&](UINT64, UINT64 begin, UINT64 end) {
+			for (UINT64 i = begin; i < end; ++i) this->CountChunk(chunks[i]);
+		});
 
-				getline(ss, s, ' '); // get line specifier
-				std::string specifier = s;
+		// the number of elements before each chunk places its elements and resolves its negative
+		// indices exactly as if the file were read in order
+		UINT64 vertexNum = 0, triangleNum = 0;
+		for (auto iter = chunks.begin(); iter != chunks.end(); ++iter)
+		{
+			iter->vertexIndex = vertexNum;
+			iter->normalIndex = normalNum_;
+			iter->texCoordIndex = texCoordNum_;
+			iter->triangleIndex = triangleNum;
+			vertexNum += iter->vertexNum;
+			normalNum_ += iter->normalNum;
+			texCoordNum_ += iter->texCoordNum;
+			triangleNum += iter->triangleNum;
+		}
 
-				while (ss)
-				{
-					std::string s;
-					if (!getline(ss, s, ' ')) break;
-					stringVec.push_back(s);
-				}
-				if (!this->ProcessLine(specifier, stringVec)) return false;
+		vertices_.resize(vertexNum * 3);
+		indices_.resize(triangleNum * 3);
+		if (calcNormals_ && normalNum_ != 0)
+		{
+			fileNormals_.resize(normalNum_ * 3);
+			normalIndices_.resize(triangleNum * 3);
+		}
 
+		std::atomic<bool> isParsed{ true };
+		threadPool.ParallelFor(chunks.size(), 1, [&](UINT64, UINT64 begin, UINT64 end) {
+			for (UINT64 i = begin; i < end; ++i) {
+				if (!this->ParseChunk(chunks[i])) isParsed = false;
 			}
-
-		}
+		});
+		if (!isParsed) return false;
 
 		// final checks
-		if (vertices_.size() == 0 || vertices_.size() % 3 != 0) return false;
+		if (vertices_.size() == 0) return false;
 		if (indices_.size() == 0) return false;
-		if (calcNormals_ && normals_.size() != vertices_.size()) return false;
+
+		if (calcNormals_) 
+		{
+			allFacesHaveNormals_ = !normalIndices_.empty();
+			for (auto iter = chunks.cbegin(); iter != chunks.cend(); ++iter)
+			{
+				allFacesHaveNormals_ = allFacesHaveNormals_ && iter->allFacesHaveNormals;
+			}
+			this->CalcNormals();
+		}
+
+		// only needed while reading
+		fileNormals_ = std::vector<float>();
+		normalIndices_ = std::vector<UINT32>();
 
 		isLoaded_ = true;
 		return true;
 	}
 
 
-	bool ObjReader::ProcessLine(const std::string& specifier,
-		const std::vector<std::string>& line) 
+	void ObjReader::CountChunk(Chunk& chunk) const
 	{
-
-		if (specifier == "v") 
+		for (const char* p = chunk.begin; p != chunk.end;)
 		{
-			if (!this->SetVertex(line)) return false;
-		}
-		else if (specifier == "f") {
-			if (!this->SetIndex(line)) return false;
-			if (calcNormals_) 
+			const char* lineEnd = FindLineEnd(p, chunk.end);
+			const char* specifierEnd = FindTokenEnd(p, lineEnd);
+			size_t specifierSize = specifierEnd - p;
+
+			if (specifierSize == 1 && p[0] == 'v') ++chunk.vertexNum;
+			else if (specifierSize == 2 && p[0] == 'v' && p[1] == 'n') ++chunk.normalNum;
+			else if (specifierSize == 2 && p[0] == 'v' && p[1] == 't') ++chunk.texCoordNum;
+			else if (specifierSize == 1 && p[0] == 'f')
 			{
-				if (!this->CalcNormal(line)) return false;
+				// a polygon is split into one triangle for each corner after the second
+				UINT64 cornerNum = 0;
+				for (const char* corner = SkipTextSpaces(specifierEnd, lineEnd); corner != lineEnd;
+					corner = SkipTextSpaces(FindTokenEnd(corner, lineEnd), lineEnd))
+				{
+					++cornerNum;
+				}
+				if (cornerNum > 2) chunk.triangleNum += cornerNum - 2;
 			}
+
+			p = NextLine(lineEnd, chunk.end);
 		}
-		return true;
 	}
 
-	bool ObjReader::SetVertex(const std::vector<std::string>& line)
+
+	bool ObjReader::ParseChunk(Chunk& chunk)
 	{
-		if (line.size() != 3) return false;
-		for (int i = 0; i < 3; ++i)
+		for (const char* p = chunk.begin; p != chunk.end;)
 		{
-			vertices_.push_back(std::stof(line[i]));
-			if (calcNormals_) normals_.push_back(0.0f);
+			const char* lineEnd = FindLineEnd(p, chunk.end);
+			if (!this->ProcessLine(p, lineEnd, chunk)) return false;
+			p = NextLine(lineEnd, chunk.end);
 		}
 		return true;
 	}
 
 
-	bool ObjReader::SetIndex(const std::vector<std::string>& line)
+	bool ObjReader::ProcessLine(const char* p, const char* lineEnd, Chunk& chunk) 
 	{
-		if (line.size() < 3) return false;
-		for (int i = 0; i < 3; ++i) 
+		const char* specifierEnd = FindTokenEnd(p, lineEnd);
+		size_t specifierSize = specifierEnd - p;
+
+		// comments, empty lines and other specifiers are ignored
+		if (specifierSize == 1 && p[0] == 'v')
+		{
+			if (!this->SetVertex(specifierEnd, lineEnd, chunk)) return false;
+		}
+		else if (specifierSize == 1 && p[0] == 'f')
+		{
+			if (!this->SetIndex(specifierEnd, lineEnd, chunk)) return false;
+		}
+		else if (specifierSize == 2 && p[0] == 'v' && p[1] == 'n')
 		{
-			std::istringstream ss(line[i]);
-			std::string vertexNum;
-			getline(ss, vertexNum, '\\');
-			indices_.push_back(std::stoi(vertexNum) - 1);
+			if (!this->SetNormal(specifierEnd, lineEnd, chunk)) return false;
 		}
-		for (int i = 3; i < line.size(); ++i) // more that 3 vertices in face
+		else if (specifierSize == 2 && p[0] == 'v' && p[1] == 't')
 		{
-			std::istringstream ss(line[i]);
-			std::string vertexNum;
-			getline(ss, vertexNum, '\\');
-			indices_.push_back(indices_[indices_.size() - 2]);
-			indices_.push_back(indices_[indices_.size() - 2]);
-			indices_.push_back(std::stoi(vertexNum) - 1);
+			++chunk.texCoordIndex;
 		}
 		return true;
 	}
 
-	bool ObjReader::CalcNormal(const std::vector<std::string>& line) {
+	bool ObjReader::SetVertex(const char* p, const char* lineEnd, Chunk& chunk)
+	{
+		if (!ParseTextValues(p, lineEnd, &vertices_[chunk.vertexIndex * 3], 3)) return false;
+		++chunk.vertexIndex;
+		return true;
+	}
+
+
+	bool ObjReader::SetNormal(const char* p, const char* lineEnd, Chunk& chunk)
+	{
+		float normal[3];
+		p = ParseTextValues(p, lineEnd, normal, 3);
+		if (!p || !IsTextLineEnd(p, lineEnd)) return false;
+
+		if (!fileNormals_.empty())
+		{
+			for (int i = 0; i < 3; ++i) fileNormals_[chunk.normalIndex * 3 + i] = normal[i];
+		}
+		++chunk.normalIndex;
+		return true;
+	}
+
+
+	bool ObjReader::SetIndex(const char* p, const char* lineEnd, Chunk& chunk)
+	{
+		UINT32 first[2] = {}, previous[2] = {};
+		size_t cornerNum = 0;
 
-		std::vector<int> indices;
-		for (size_t i = 0; i < line.size(); ++i)
+		while (!IsTextLineEnd(p, lineEnd))
 		{
-			indices.push_back(stoi(line[i]) - 1);
-			if ((size_t) indices[i] * 3 + 2 > vertices_.size())
+			if (!IsTextSpace(*p)) return false;
+
+			UINT32 corner[2];
+			p = this->ParseCorner(SkipTextSpaces(p, lineEnd), lineEnd, chunk, corner[0], corner[1]);
+			if (!p) return false;
+
+			if (cornerNum == 0)
 			{
-				return false; // index outside of vertex range
+				first[0] = corner[0];
+				first[1] = corner[1];
 			}
+			else if (cornerNum >= 2) // more that 3 vertices in face share the first vertex
+			{
+				UINT32* indices = &indices_[chunk.triangleIndex * 3];
+				indices[0] = first[0];
+				indices[1] = previous[0];
+				indices[2] = corner[0];
+				if (!normalIndices_.empty())
+				{
+					UINT32* normalIndices = &normalIndices_[chunk.triangleIndex * 3];
+					normalIndices[0] = first[1];
+					normalIndices[1] = previous[1];
+					normalIndices[2] = corner[1];
+					if (first[1] == OBJ_NO_INDEX || previous[1] == OBJ_NO_INDEX ||
+						corner[1] == OBJ_NO_INDEX) chunk.allFacesHaveNormals = false;
+				}
+				++chunk.triangleIndex;
+			}
+
+			previous[0] = corner[0];
+			previous[1] = corner[1];
+			++cornerNum;
 		}
+		return cornerNum >= 3;
+	}
+
 
-		for (size_t iFace = 0; iFace < line.size() - 2; ++iFace)
+	/*
+	* ResolveObjIndex: converts a 1 based or negative (relative to the last element read) .obj
+	* index into a zero based index. Returns false if the index is outside of the file
+	* 
+	* _IN_ index: the index in the file
+	* _IN_ count: the number of elements read before the index
+	* _IN_ total: the number of elements in the whole file
+	* _OUT_ result: the zero based index
+	*/
+	static bool ResolveObjIndex(const INT64& index, const UINT64& count, const UINT64& total,
+		UINT32& result)
+	{
+		if (index > 0 && (UINT64)index <= total && (UINT64)index <= OBJ_NO_INDEX)
 		{
-			float vector1[3], vector2[3], normal[3];
+			result = (UINT32)(index - 1);
+			return true;
+		}
+		if (index < 0 && (UINT64)(-index) <= count)
+		{
+			result = (UINT32)(count + index);
+			return true;
+		}
+		return false;
+	}
 
-			for (int i = 0; i < 3; ++i) {
-				vector1[i] = vertices_[(size_t) indices[iFace + 1] * 3 + i] -
-					vertices_[(size_t)indices[iFace] * 3 + i];
-				vector2[i] = vertices_[(size_t)indices[iFace + 2] * 3 + i] -
-					vertices_[(size_t)indices[iFace] * 3 + i];
-			}
 
-			normal[0] = vector1[1] * vector2[2] -
-				vector1[2] * vector2[1];
-			normal[1] = vector1[2] * vector2[0] -
-				vector1[0] * vector2[2];
-			normal[2] = vector1[0] * vector2[1] -
-				vector1[1] * vector2[0];
+	const char* ObjReader::ParseCorner(const char* p, const char* lineEnd, const Chunk& chunk,
+		UINT32& vertex, UINT32& normal) const
+	{
+		INT64 index;
+		p = ParseTextValue(p, lineEnd, index);
+		if (!p || !ResolveObjIndex(index, chunk.vertexIndex, vertices_.size() / 3, vertex)) return nullptr;
 
-			for (int iVertex = 0; iVertex < 3; ++iVertex) 
+		normal = OBJ_NO_INDEX;
+		if (p == lineEnd || *p != '/') return p;
+		++p;
+
+		// the texture coordinate is checked but not stored
+		if (p != lineEnd && *p != '/')
+		{
+			UINT32 texCoord;
+			p = ParseTextValue(p, lineEnd, index);
+			if (!p || !ResolveObjIndex(index, chunk.texCoordIndex, texCoordNum_, texCoord)) return nullptr;
+		}
+
+		if (p == lineEnd || *p != '/') return p;
+		++p;
+
+		p = ParseTextValue(p, lineEnd, index);
+		if (!p || !ResolveObjIndex(index, chunk.normalIndex, normalNum_, normal)) return nullptr;
+		return p;
+	}
+
+
+	void ObjReader::CalcNormals() 
+	{
+		normals_.assign(vertices_.size(), 0.0f);
+
+		if (allFacesHaveNormals_)
+		{
+			for (size_t i = 0; i < indices_.size(); ++i)
 			{
-				for (int iIndex = 0; iIndex < 3; ++iIndex) 
+				for (int j = 0; j < 3; ++j)
 				{
-					normals_[(size_t)indices[iFace + iIndex] * 3 + iVertex]
-						+= normal[iVertex];
+					normals_[(size_t)indices_[i] * 3 + j] += fileNormals_[(size_t)normalIndices_[i] * 3 + j];
 				}
 			}
+			return;
 		}
-		return true;
+
+		SumFaceNormals(&vertices_[0], &indices_[0], indices_.size() / 3, &normals_[0]);
 	}
 
 
@@ -0,0 +1,159 @@
+/*
+*
+* Implimentation of the binary .prt format (see PRTBinary.h)
+*
+*
+* Forms part of the DxPRT project
+*
+*
+*
+* Author: Shaun Bailey
+*
+* Date created: 16/10/2026
+*
+* Last Updated: 16/10/2026
+*
+*
+*
+* MIT License
+*
+* Copyright (c) 2021 Shaun Bailey
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*
+*/
+
+#include "DxPRT/PRTBinary.h"
+#include <cstring>
+
+
+namespace DxPRT_Utility {
+
+	static const UINT64 FNV_PRIME = 0x100000001b3ull;
+
+
+	// rounds up to the next multiple of PRT_BINARY_ALIGNMENT
+	static UINT64 AlignSection(const UINT64& offset)
+	{
+		return (offset + PRT_BINARY_ALIGNMENT - 1) / PRT_BINARY_ALIGNMENT * PRT_BINARY_ALIGNMENT;
+	}
+
+
+	void InitializePRTBinaryHeader(PRTBinaryHeader& header, const UINT64& maxL, const UINT64& vertexNum,
+		const UINT64& indexNum, const UINT64& coefficientNum, const bool& isEM)
+	{
+		header = {};
+		memcpy(header.magic, PRT_BINARY_MAGIC, sizeof(header.magic));
+		header.version = PRT_BINARY_VERSION;
+		header.flags = isEM ? PRT_BINARY_FLAG_EM : 0;
+		header.maxL = maxL;
+		header.vertexNum = vertexNum;
+		header.indexNum = indexNum;
+		header.coefficientNum = coefficientNum;
+
+		header.vertexOffset = PRT_BINARY_HEADER_SIZE;
+		header.indexOffset = AlignSection(header.vertexOffset + vertexNum * sizeof(NumberedVertex));
+		header.coefficientOffset = AlignSection(header.indexOffset + indexNum * sizeof(UINT32));
+		header.fileSize = AlignSection(header.coefficientOffset + coefficientNum * sizeof(float));
+		header.checksum = 0;
+	}
+
+
+	bool CheckPRTBinaryHeader(const PRTBinaryHeader& header, const UINT64& fileSize, const bool& isEM)
+	{
+		if (!IsPRTBinary(header.magic, sizeof(header.magic))) return false;
+		if (header.version > PRT_BINARY_VERSION) return false; // written by a newer version
+		if (((header.flags & PRT_BINARY_FLAG_EM) != 0) != isEM) return false;
+		if ((header.flags & PRT_BINARY_FLAG_INCOMPLETE) != 0) return false; // still being written
+		if (header.maxL > PRT_MAX_L) return false; // also guards against overflow below
+
+		UINT64 nCoefficients = (header.maxL + 1) * (header.maxL + 1);
+		if (isEM)
+		{
+			if (header.vertexNum != 0 || header.indexNum != 0) return false;
+			if (header.coefficientNum != nCoefficients * 3) return false;
+		}
+		else
+		{
+			if (header.vertexNum == 0 || header.indexNum == 0 || header.indexNum % 3 != 0) return false;
+			if (header.vertexNum > fileSize || header.indexNum > fileSize) return false;
+			if (header.coefficientNum != nCoefficients * header.vertexNum) return false;
+		}
+
+		// the sections must be exactly where the writer places them
+		PRTBinaryHeader expected;
+		InitializePRTBinaryHeader(expected, header.maxL, header.vertexNum, header.indexNum,
+			header.coefficientNum, isEM);
+		if (header.vertexOffset != expected.vertexOffset || header.indexOffset != expected.indexOffset ||
+			header.coefficientOffset != expected.coefficientOffset || header.fileSize != expected.fileSize)
+		{
+			return false;
+		}
+
+		return header.fileSize == fileSize;
+	}
+
+
+	bool IsPRTBinary(const char* data, const size_t& size)
+	{
+		return size >= sizeof(PRT_BINARY_MAGIC) && memcmp(data, PRT_BINARY_MAGIC, sizeof(PRT_BINARY_MAGIC)) == 0;
+	}
+
+
+	void UpdatePRTChecksum(PRTChecksum& checksum, const void* data, const size_t& size)
+	{
+		const unsigned char* bytes = (const unsigned char*)data;
+		size_t i = 0;
+
+		// complete a partially filled word
+		for (; i < size && checksum.byteNum != 0; ++i)
+		{
+			checksum.word |= UINT64(bytes[i]) << (8 * checksum.byteNum);
+			if (++checksum.byteNum == 8)
+			{
+				checksum.hash = (checksum.hash ^ checksum.word) * FNV_PRIME;
+				checksum.word = 0;
+				checksum.byteNum = 0;
+			}
+		}
+
+		UINT64 hash = checksum.hash;
+		for (; i + 8 <= size; i += 8)
+		{
+			UINT64 word;
+			memcpy(&word, bytes + i, 8);
+			hash = (hash ^ word) * FNV_PRIME;
+		}
+		checksum.hash = hash;
+
+		for (; i < size; ++i)
+		{
+			checksum.word |= UINT64(bytes[i]) << (8 * checksum.byteNum);
+			++checksum.byteNum;
+		}
+	}
+
+
+	UINT64 FinalizePRTChecksum(const PRTChecksum& checksum)
+	{
+		if (checksum.byteNum == 0) return checksum.hash;
+		return (checksum.hash ^ checksum.word) * FNV_PRIME;
+	}
+
+}
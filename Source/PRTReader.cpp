@@ -39,10 +39,104 @@
 */
 
 #include "DxPRT/PRTReader.h"
+#include "DxPRT/TextParsing.h"
+#include "DxPRT/ThreadPool.h"
+#include <atomic>
+#include <cstring>
 
 
 namespace DxPRT_Utility {
 
+	// a range of whole lines of a text .prt file
+	struct PRTTextChunk
+	{
+		const char* begin = nullptr;
+		const char* end = nullptr;
+
+		UINT64 vertexNum = 0, faceNum = 0, maxLNum = 0;
+		const char* firstMaxL = nullptr; // the first 'L' line
+		const char* firstData = nullptr; // the first 'v' or 'f' line
+
+		// the index of the first vertex and face of the chunk in the whole file
+		UINT64 vertexStart = 0, faceStart = 0;
+	};
+
+
+	// returns the specifier of the line ('v', 'f', 'L' or 'c'), or 0 if the line is ignored
+	static char GetPRTTextSpecifier(const char* p, const char* lineEnd) {
+		if (p == lineEnd) return 0;
+		if (lineEnd - p > 1 && !IsTextSpace(p[1])) return 0;
+		if (*p == 'v' || *p == 'f' || *p == 'L' || *p == 'c') return *p;
+		return 0;
+	}
+
+
+	// parses an 'L' line starting at p
+	static bool ParsePRTTextMaxL(const char* p, const char* end, size_t& maxL) {
+		const char* lineEnd = FindLineEnd(p, end);
+		p = ParseTextValues(p + 1, lineEnd, &maxL, 1);
+		return p && IsTextLineEnd(p, lineEnd);
+	}
+
+
+	// counts the lines of each type in the chunk
+	static void CountPRTTextLines(PRTTextChunk& chunk) {
+		for (const char* p = chunk.begin; p != chunk.end;) {
+			const char* lineEnd = FindLineEnd(p, chunk.end);
+			char specifier = GetPRTTextSpecifier(p, lineEnd);
+
+			if (specifier == 'v' || specifier == 'f') {
+				if (!chunk.firstData) chunk.firstData = p;
+				if (specifier == 'v') ++chunk.vertexNum;
+				else ++chunk.faceNum;
+			}
+			else if (specifier == 'L') {
+				if (!chunk.firstMaxL) chunk.firstMaxL = p;
+				++chunk.maxLNum;
+			}
+
+			p = NextLine(lineEnd, chunk.end);
+		}
+	}
+
+
+	/*
+	* ParsePRTTextChunk: parses the 'v' and 'f' lines of the chunk. Returns false if a line has
+	* the wrong number of values or a value is not a number
+	*
+	* _IN_ chunk: the counted chunk
+	* _IN_ nCoefficients: the number of coefficients of each vertex
+	* _OUT_ vertices: the positions of the first vertex of the chunk
+	* _OUT_ coefficients: the coefficients of the first vertex of the chunk
+	* _OUT_ indices: the indices of the first face of the chunk
+	*/
+	static bool ParsePRTTextChunk(const PRTTextChunk& chunk, const size_t& nCoefficients,
+		float* vertices, float* coefficients, UINT32* indices) {
+
+		for (const char* p = chunk.begin; p != chunk.end;) {
+			const char* lineEnd = FindLineEnd(p, chunk.end);
+			char specifier = GetPRTTextSpecifier(p, lineEnd);
+
+			const char* pValue = p + 1;
+			if (specifier == 'v') {
+				pValue = ParseTextValues(pValue, lineEnd, vertices, 3);
+				if (pValue) pValue = ParseTextValues(pValue, lineEnd, coefficients, nCoefficients);
+				if (!pValue || !IsTextLineEnd(pValue, lineEnd)) return false;
+				vertices += 3;
+				coefficients += nCoefficients;
+			}
+			else if (specifier == 'f') {
+				pValue = ParseTextValues(pValue, lineEnd, indices, 3);
+				if (!pValue || !IsTextLineEnd(pValue, lineEnd)) return false;
+				indices += 3;
+			}
+
+			p = NextLine(lineEnd, chunk.end);
+		}
+		return true;
+	}
+
+
 	PRTReader::PRTReader(const std::string &fileName, const bool &isEM) {
 		if (!this->Load(fileName, isEM))
 		{
@@ -57,40 +151,23 @@ namespace DxPRT_Utility {
 
 	bool PRTReader::Load(const std::string &fileName, const bool &isEM) {
 
-		std::ifstream infile(fileName);
-		if (infile.fail()) return false;
-
-		while (infile) {
-			std::string s;
-			if (!getline(infile, s)) break;
-
-			// ignore comments and empty lines
-			if (s[0] != '#' && s != "") {
-
-				std::istringstream ss(s);
-				std::vector<std::string> stringVec;
-
-				// get line specifier
-				getline(ss, s, ' ');
-				std::string specifier = s;
-
-				while (ss)
-				{
-					std::string s;
-					if (!getline(ss, s, ' ')) break;
-					stringVec.push_back(s);
-				}
+		// clear any previously loaded file
+		*this = PRTReader();
 
-				if (isEM) {
-					if (!this->ProcessLineEM(specifier, stringVec)) return false;
-				}
-				else {
-					if (!this->ProcessLine(specifier, stringVec)) return false;
-				}
-			}
+		std::shared_ptr<MappedFile> file = std::make_shared<MappedFile>();
+		if (!file->Open(fileName)) return false;
 
+		if (IsPRTBinary(file->GetData(), file->GetSize())) {
+			mappedFile_ = file;
+			return this->LoadBinary(isEM);
 		}
 
+		// text files are parsed into the vectors, so the mapping is not kept
+		bool isParsed = isEM ? this->LoadTextEM(file->GetData(), file->GetSize())
+			: this->LoadText(file->GetData(), file->GetSize());
+		file->Close();
+		if (!isParsed) return false;
+
 		// final checks
 		if (isEM) {
 			if (coefficients_.size() != nCoefficients_ * 3) return false;
@@ -107,71 +184,131 @@ namespace DxPRT_Utility {
 	}
 
 
-	bool PRTReader::ProcessLine(const std::string& specifier,
-		const std::vector<std::string>& line) {
-
+	bool PRTReader::LoadBinary(const bool& isEM) {
 
-		if (specifier == "v") {
-			if (!maxLFound_) return false;
-			if (!this->SetVertex(line)) return false;
-		}
-		else if (specifier == "f") {
-			if (!this->SetIndex(line)) return false;
-		}
-		else if (specifier == "L") {
-			if (maxLFound_ || line.size() != 1) return false;
-			maxL_ = std::stoi(line[0]);
-			nCoefficients_ = (maxL_ + 1) * (maxL_ + 1);
-			maxLFound_ = true;
-		}
-		return true;
-	}
+		const char* data = mappedFile_->GetData();
+		size_t size = mappedFile_->GetSize();
+		if (size < PRT_BINARY_HEADER_SIZE) return false;
 
-	bool PRTReader::ProcessLineEM(const std::string& specifier,
-		const std::vector<std::string>& line) {
+		memcpy(&header_, data, sizeof(header_));
+		if (!CheckPRTBinaryHeader(header_, size, isEM)) return false;
 
-		if (specifier == "L") {
-			if (maxLFound_ || line.size() != 1) return false;
-			maxL_ = std::stoi(line[0]);
-			nCoefficients_ = (maxL_ + 1) * (maxL_ + 1);
-			maxLFound_ = true;
-		}
-		else if (specifier == "c") {
-			if (line.size() != nCoefficients_ * 3 || !maxLFound_) return false;
-			for (auto iter = line.cbegin(); iter != line.cend(); ++iter) {
-				coefficients_.push_back(std::stof(*iter));
-			}
-		}
+		PRTChecksum checksum;
+		UpdatePRTChecksum(checksum, data + PRT_BINARY_HEADER_SIZE, size - PRT_BINARY_HEADER_SIZE);
+		if (FinalizePRTChecksum(checksum) != header_.checksum) return false;
 
+		maxL_ = header_.maxL;
+		nCoefficients_ = (maxL_ + 1) * (maxL_ + 1);
+		maxLFound_ = true;
+		isBinary_ = true;
+		isLoaded_ = true;
 		return true;
 	}
 
-	bool PRTReader::SetVertex(const std::vector<std::string>& line) {
 
-		if (line.size() != 3 + nCoefficients_ || !maxLFound_) return false;
+	bool PRTReader::LoadText(const char* data, const size_t& size) {
 
-		for (int i = 0; i < 3; ++i) {
-			vertices_.push_back(std::stof(line[i]));
+		// small files are parsed on the calling thread
+		ThreadPool threadPool(size < TEXT_CHUNK_SIZE ? 1 : 0);
+		std::vector<const char*> chunkBounds = SplitTextLines(data, size, threadPool.GetNumThreads());
+		UINT64 chunkNum = chunkBounds.size() - 1;
+		std::vector<PRTTextChunk> chunks(chunkNum);
+		for (UINT64 i = 0; i < chunkNum; ++i) {
+			chunks[i].begin = chunkBounds[i];
+			chunks[i].end = chunkBounds[i + 1];
 		}
-		for (int i = 0; i < nCoefficients_; ++i) {
-			coefficients_.push_back(std::stof(line[3 + i]));
+
+		// count the lines first, such that the vectors are allocated once and each chunk
+		// is parsed directly into its place
+		threadPool.ParallelFor(chunkNum, 1, [&](UINT64, UINT64 begin, UINT64 end) {
+			for (UINT64 i = begin; i < end; ++i) {
+				CountPRTTextLines(chunks[i]);
+			}
+		});
+
+		UINT64 vertexNum = 0, faceNum = 0, maxLNum = 0;
+		const char* maxLLine = nullptr;
+		const char* dataLine = nullptr;
+		for (auto iter = chunks.begin(); iter != chunks.end(); ++iter) {
+			iter->vertexStart = vertexNum;
+			iter->faceStart = faceNum;
+			vertexNum += iter->vertexNum;
+			faceNum += iter->faceNum;
+			maxLNum += iter->maxLNum;
+			if (!maxLLine) maxLLine = iter->firstMaxL;
+			if (!dataLine) dataLine = iter->firstData;
 		}
 
-		return true;
+		// L must be given once, before any vertices or indices
+		if (maxLNum != 1 || (dataLine && dataLine < maxLLine)) return false;
+		if (!ParsePRTTextMaxL(maxLLine, data + size, maxL_) || maxL_ > PRT_MAX_L) return false;
+
+		// every value takes at least two characters, so larger counts cannot be valid
+		nCoefficients_ = (maxL_ + 1) * (maxL_ + 1);
+		if (vertexNum != 0 && nCoefficients_ + 3 > size / vertexNum) return false;
+		maxLFound_ = true;
+
+		vertices_.resize(vertexNum * 3);
+		coefficients_.resize(vertexNum * nCoefficients_);
+		indices_.resize(faceNum * 3);
+
+		std::atomic<bool> isParsed{ true };
+		threadPool.ParallelFor(chunkNum, 1, [&](UINT64, UINT64 begin, UINT64 end) {
+			for (UINT64 i = begin; i < end; ++i) {
+				if (!ParsePRTTextChunk(chunks[i], nCoefficients_, vertices_.data() + chunks[i].vertexStart * 3,
+					coefficients_.data() + chunks[i].vertexStart * nCoefficients_,
+					indices_.data() + chunks[i].faceStart * 3)) {
+					isParsed = false;
+				}
+			}
+		});
 
+		return isParsed;
 	}
 
-	bool PRTReader::SetIndex(const std::vector<std::string>& line) {
-		if (line.size() != 3 || !maxLFound_) return false;
 
-		for (int i = 0; i < 3; ++i) {
-			indices_.push_back(std::stoul(line[i]));
+	bool PRTReader::LoadTextEM(const char* data, const size_t& size) {
+
+		const char* end = data + size;
+		for (const char* p = data; p != end;) {
+			const char* lineEnd = FindLineEnd(p, end);
+			char specifier = GetPRTTextSpecifier(p, lineEnd);
+
+			if (specifier == 'L') {
+				if (maxLFound_ || !ParsePRTTextMaxL(p, end, maxL_) || maxL_ > PRT_MAX_L) return false;
+				nCoefficients_ = (maxL_ + 1) * (maxL_ + 1);
+				maxLFound_ = true;
+			}
+			else if (specifier == 'c') {
+				if (!maxLFound_) return false;
+				size_t iCoefficient = coefficients_.size();
+				coefficients_.resize(iCoefficient + nCoefficients_ * 3);
+				const char* pValue = ParseTextValues(p + 1, lineEnd, &coefficients_[iCoefficient],
+					nCoefficients_ * 3);
+				if (!pValue || !IsTextLineEnd(pValue, lineEnd)) return false;
+			}
+
+			p = NextLine(lineEnd, end);
 		}
+
 		return true;
 	}
 
+
 	float* PRTReader::GetVertices() {
-		if (isLoaded_) return &vertices_[0];
+		if (isLoaded_ && isBinary_) {
+			if (vertices_.empty()) { // only stored with the numbered vertices
+				const NumberedVertex* pVertex = this->GetNumberedVertices();
+				vertices_.resize(header_.vertexNum * 3);
+				for (size_t i = 0; i < header_.vertexNum; ++i) {
+					for (int j = 0; j < 3; ++j) {
+						vertices_[i * 3 + j] = pVertex[i].vertex[j];
+					}
+				}
+			}
+			return &vertices_[0];
+		}
+		else if (isLoaded_) return &vertices_[0];
 		else {
 			this->NotLoadedMessage();
 			return nullptr;
@@ -180,7 +317,8 @@ namespace DxPRT_Utility {
 
 
 	float* PRTReader::GetCoefficients() {
-		if (isLoaded_) return &coefficients_[0];
+		if (isLoaded_ && isBinary_) return (float*)(mappedFile_->GetData() + header_.coefficientOffset);
+		else if (isLoaded_) return &coefficients_[0];
 		else {
 			this->NotLoadedMessage();
 			return nullptr;
@@ -188,7 +326,8 @@ namespace DxPRT_Utility {
 	}
 
 	UINT32* PRTReader::GetIndices() {
-		if (isLoaded_) return &indices_[0];
+		if (isLoaded_ && isBinary_) return (UINT32*)(mappedFile_->GetData() + header_.indexOffset);
+		else if (isLoaded_) return &indices_[0];
 		else {
 			this->NotLoadedMessage();
 			return nullptr;
@@ -197,7 +336,10 @@ namespace DxPRT_Utility {
 
 
 	NumberedVertex* PRTReader::GetNumberedVertices() {
-		if (isLoaded_) {
+		if (isLoaded_ && isBinary_) {
+			return (NumberedVertex*)(mappedFile_->GetData() + header_.vertexOffset);
+		}
+		else if (isLoaded_) {
 			if (!numberedCalculated_) {
 				this->CalcNumberedVertices();
 				numberedCalculated_ = true;
@@ -211,14 +353,16 @@ namespace DxPRT_Utility {
 	}
 
 	size_t PRTReader::GetSizeVertices() const{
-		if (isLoaded_) return vertices_.size();
+		if (isLoaded_ && isBinary_) return header_.vertexNum * 3;
+		else if (isLoaded_) return vertices_.size();
 		else {
 			this->NotLoadedMessage();
 			return 0;
 		}
 	}
 	size_t PRTReader::GetSizeIndices() const{
-		if (isLoaded_) return indices_.size();
+		if (isLoaded_ && isBinary_) return header_.indexNum;
+		else if (isLoaded_) return indices_.size();
 		else {
 			this->NotLoadedMessage();
 			return 0;
@@ -226,7 +370,8 @@ namespace DxPRT_Utility {
 	}
 
 	size_t PRTReader::GetSizeCoefficients() const{
-		if (isLoaded_) return coefficients_.size();
+		if (isLoaded_ && isBinary_) return header_.coefficientNum;
+		else if (isLoaded_) return coefficients_.size();
 		else {
 			this->NotLoadedMessage();
 			return 0;
@@ -234,7 +379,8 @@ namespace DxPRT_Utility {
 	}
 
 	size_t PRTReader::GetSizeNumberedVertices() const{
-		if (isLoaded_) {
+		if (isLoaded_ && isBinary_) return header_.vertexNum;
+		else if (isLoaded_) {
 			if (numberedCalculated_) {
 				return numberedVertices_.size();
 			}
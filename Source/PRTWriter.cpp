@@ -39,6 +39,14 @@
 */
 
 #include "DxPRT/PRTWriter.h"
+#include "DxPRT/PRTBinary.h"
+#include "DxPRT/TextParsing.h"
+#include "DxPRT/ThreadPool.h"
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <functional>
+#include <vector>
 
 
 namespace DxPRT_Utility {
@@ -48,7 +56,8 @@ namespace DxPRT_Utility {
 		vertexSize_(0), indexSize_(0), coefficientSize_(0),
 		nCoefficients_(0), maxL_(0) {}
 
-	bool PRTWriter::Write(const std::string &filename, const bool &isEM) {
+	bool PRTWriter::Write(const std::string &filename, const bool &isEM,
+		const DxPRT::PRT_FILE_FORMAT& format) {
 
 		if (isEM && !addedCoefficients_) return false;
 		if (!isEM && (!addedCoefficients_ || !addedIndices_ ||
@@ -56,6 +65,12 @@ namespace DxPRT_Utility {
 
 		std::ofstream outFile;
 
+		if (format == DxPRT::PRT_FILE_FORMAT_BINARY) {
+			outFile.open(filename, std::ofstream::binary);
+			if (outFile.fail()) return false;
+			return this->writeBinary(outFile, isEM);
+		}
+
 		outFile.open(filename);
 		if (outFile.fail()) return false;
 
@@ -70,7 +85,7 @@ namespace DxPRT_Utility {
 		}
 		outFile.close();
 
-		return true;
+		return !outFile.fail();
 	}
 
 
@@ -96,36 +111,368 @@ namespace DxPRT_Utility {
 		addedIndices_ = true;
 	}
 
+	// writes data to the file and adds it to the checksum
+	static void WriteChecked(std::ostream& file, PRTChecksum& checksum, const void* data,
+		const size_t& size) {
+		file.write((const char*)data, size);
+		UpdatePRTChecksum(checksum, data, size);
+	}
+
+	// writes zeros up to the given offset
+	static void WritePadding(std::ostream& file, PRTChecksum& checksum, const UINT64& offset) {
+		const char zeros[PRT_BINARY_ALIGNMENT] = {};
+		UINT64 position = (UINT64)file.tellp();
+		while (position < offset) {
+			size_t size = (size_t)(std::min)(offset - position, PRT_BINARY_ALIGNMENT);
+			WriteChecked(file, checksum, zeros, size);
+			position += size;
+		}
+	}
+
+
+	// writes the vertex and index sections of a binary file, including the padding up to the
+	// coefficient section
+	static void WriteMeshSections(std::ostream& file, PRTChecksum& checksum,
+		const PRTBinaryHeader& header, const float* pVertex, const UINT32* pIndex) {
+
+		// the vertices are converted to the layout of the vertex buffer a block at a time
+		const UINT64 blockSize = 65536;
+		std::vector<NumberedVertex> block((size_t)(std::min)(header.vertexNum, blockSize));
+		for (UINT64 begin = 0; begin < header.vertexNum; begin += blockSize) {
+			UINT64 end = (std::min)(header.vertexNum, begin + blockSize);
+			for (UINT64 i = begin; i < end; ++i) {
+				NumberedVertex& numberedVertex = block[i - begin];
+				for (int j = 0; j < 3; ++j) {
+					numberedVertex.vertex[j] = pVertex[3 * i + j];
+				}
+				numberedVertex.index = (UINT32)i;
+			}
+			WriteChecked(file, checksum, &block[0], (end - begin) * sizeof(NumberedVertex));
+		}
+		WritePadding(file, checksum, header.indexOffset);
+
+		if (header.indexNum > 0) WriteChecked(file, checksum, pIndex, header.indexNum * sizeof(UINT32));
+		WritePadding(file, checksum, header.coefficientOffset);
+	}
+
+
+	bool PRTWriter::writeBinary(std::ofstream& file, const bool& isEM) const {
+
+		UINT64 vertexNum = isEM ? 0 : vertexSize_ / 3;
+		UINT64 indexNum = isEM ? 0 : indexSize_;
+		if (!isEM && coefficientSize_ != vertexNum * nCoefficients_) return false;
+		if (isEM && coefficientSize_ != nCoefficients_ * 3) return false;
+
+		PRTBinaryHeader header;
+		InitializePRTBinaryHeader(header, maxL_, vertexNum, indexNum, coefficientSize_, isEM);
+
+		// space for the header, which is written once the checksum is known
+		const char emptyHeader[PRT_BINARY_HEADER_SIZE] = {};
+		file.write(emptyHeader, PRT_BINARY_HEADER_SIZE);
+
+		PRTChecksum checksum;
+		WriteMeshSections(file, checksum, header, pVertex_, pIndex_);
+
+		WriteChecked(file, checksum, pCoefficient_, coefficientSize_ * sizeof(float));
+		WritePadding(file, checksum, header.fileSize);
+
+		header.checksum = FinalizePRTChecksum(checksum);
+		file.seekp(0);
+		file.write((const char*)&header, sizeof(header));
+		file.close();
+
+		return !file.fail();
+	}
+
+
+	/*
+	* WriteTextLines: formats the lines of a text file and writes them in order. The lines are
+	* split into blocks of around TEXT_CHUNK_SIZE bytes, each of which is formatted into its own
+	* buffer in parallel, after which the buffers are written with a single call each
+	*
+	* _IN/OUT_ file: the file being written
+	* _IN_ lineNum: the number of lines
+	* _IN_ maxLineSize: the most characters that formatLine writes for a single line
+	* _IN_ formatLine: called as formatLine(iLine, p), writes line iLine at p and returns the end
+	*/
+	static void WriteTextLines(std::ofstream& file, const UINT64& lineNum, const size_t& maxLineSize,
+		const std::function<char*(UINT64, char*)>& formatLine) {
+
+		UINT64 blockLineNum = (std::max)(UINT64(1), UINT64(TEXT_CHUNK_SIZE / maxLineSize));
+		UINT64 blockNum = (lineNum + blockLineNum - 1) / blockLineNum;
+
+		// each thread formats around 2 blocks before they are written, which bounds the memory used
+		ThreadPool threadPool(blockNum > 1 ? 0 : 1);
+		UINT64 roundBlockNum = (std::min)(blockNum, threadPool.GetNumThreads() * 2);
+		std::vector<std::vector<char>> buffers((size_t)roundBlockNum,
+			std::vector<char>((size_t)(blockLineNum * maxLineSize)));
+		std::vector<size_t> sizes((size_t)roundBlockNum);
+
+		for (UINT64 roundBegin = 0; roundBegin < blockNum; roundBegin += roundBlockNum) {
+			UINT64 roundEnd = (std::min)(blockNum, roundBegin + roundBlockNum);
+
+			threadPool.ParallelFor(roundEnd - roundBegin, 1, [&](UINT64, UINT64 begin, UINT64 end) {
+				for (UINT64 iBlock = begin; iBlock < end; ++iBlock) {
+					char* start = &buffers[iBlock][0];
+					char* p = start;
+					UINT64 lineBegin = (roundBegin + iBlock) * blockLineNum;
+					UINT64 lineEnd = (std::min)(lineNum, lineBegin + blockLineNum);
+					for (UINT64 iLine = lineBegin; iLine < lineEnd; ++iLine) {
+						p = formatLine(iLine, p);
+					}
+					sizes[iBlock] = p - start;
+				}
+			});
+
+			for (UINT64 iBlock = 0; iBlock < roundEnd - roundBegin; ++iBlock) {
+				file.write(&buffers[iBlock][0], sizes[iBlock]);
+			}
+		}
+	}
+
+
 	void PRTWriter::writeVertices(std::ofstream& file) const {
-		for (int i = 0; i < vertexSize_ / 3; ++i) {
-			file << "v";
+		size_t maxLineSize = 2 + (3 + nCoefficients_) * (TEXT_VALUE_MAX_SIZE + 1);
+		WriteTextLines(file, vertexSize_ / 3, maxLineSize, [this](UINT64 i, char* p) {
+			*p++ = 'v';
 			for (int j = 0; j < 3; ++j) {
-				file << " " << *(pVertex_ + 3 * i + j);
+				*p++ = ' ';
+				p = FormatTextValue(p, pVertex_[3 * i + j]);
 			}
-			for (int j = 0; j < nCoefficients_; ++j) {
-				file << " " << *(pCoefficient_ + i * nCoefficients_ + j);
+			for (size_t j = 0; j < nCoefficients_; ++j) {
+				*p++ = ' ';
+				p = FormatTextValue(p, pCoefficient_[i * nCoefficients_ + j]);
 			}
-			file << "\n";
-		}
+			*p++ = '\n';
+			return p;
+		});
 	}
 
 	void PRTWriter::writeIndices(std::ofstream& file) const {
-		for (int i = 0; i < indexSize_ / 3; ++i) {
-			file << "f";
+		size_t maxLineSize = 2 + 3 * (TEXT_VALUE_MAX_SIZE + 1);
+		WriteTextLines(file, indexSize_ / 3, maxLineSize, [this](UINT64 i, char* p) {
+			*p++ = 'f';
 			for (int j = 0; j < 3; ++j) {
-				file << " " << *(pIndex_ + 3 * i + j);
+				*p++ = ' ';
+				p = FormatTextValue(p, pIndex_[3 * i + j]);
 			}
-			file << "\n";
-		}
+			*p++ = '\n';
+			return p;
+		});
 	}
 
 
 	void PRTWriter::writeCoefficients(std::ofstream& file) const {
-		file << "c ";
-		for (int j = 0; j < nCoefficients_ * 3; ++j) {
-			file << *(pCoefficient_ + j);
-			if (j != nCoefficients_ * 3 - 1) file << " ";
+		std::vector<char> buffer(2 + nCoefficients_ * 3 * (TEXT_VALUE_MAX_SIZE + 1));
+		char* p = &buffer[0];
+		*p++ = 'c';
+		*p++ = ' ';
+		for (size_t j = 0; j < nCoefficients_ * 3; ++j) {
+			p = FormatTextValue(p, pCoefficient_[j]);
+			if (j != nCoefficients_ * 3 - 1) *p++ = ' ';
+		}
+		file.write(&buffer[0], p - &buffer[0]);
+	}
+
+
+	// the record kept after the coefficients of an unfinished file, followed by a bit for each vertex
+	// that has been written
+	struct PRTStreamRecord
+	{
+		UINT64 settingsKey;
+		UINT64 meshChecksum; // checksum of the sections before the coefficients
+	};
+
+
+	PRTStreamWriter::PRTStreamWriter() {}
+
+	bool PRTStreamWriter::Open(const std::string& fileName, const int& maxL, const float* pVertex,
+		const size_t& vertexSize, const UINT32* pIndex, const size_t& indexSize, const UINT64& settingsKey) {
+		return open(fileName, maxL, pVertex, vertexSize, pIndex, indexSize, settingsKey, false);
+	}
+
+	bool PRTStreamWriter::Resume(const std::string& fileName, const int& maxL, const float* pVertex,
+		const size_t& vertexSize, const UINT32* pIndex, const size_t& indexSize, const UINT64& settingsKey) {
+		return open(fileName, maxL, pVertex, vertexSize, pIndex, indexSize, settingsKey, true);
+	}
+
+
+	bool PRTStreamWriter::open(const std::string& fileName, const int& maxL, const float* pVertex,
+		const size_t& vertexSize, const UINT32* pIndex, const size_t& indexSize,
+		const UINT64& settingsKey, const bool& resume) {
+
+		std::lock_guard<std::mutex> lock(mutex_);
+
+		if (file_.is_open()) file_.close();
+		isOpen_ = false;
+		fileName_ = fileName;
+
+		UINT64 vertexNum = vertexSize / 3;
+		nCoefficients_ = (maxL + 1) * (maxL + 1);
+		InitializePRTBinaryHeader(header_, maxL, vertexNum, indexSize, vertexNum * nCoefficients_, false);
+		header_.flags |= PRT_BINARY_FLAG_INCOMPLETE;
+
+		if (resume && resumeFile(pVertex, pIndex, settingsKey)) {
+			isOpen_ = true;
+			return true;
 		}
+
+		if (file_.is_open()) file_.close();
+		written_.assign((size_t)((vertexNum + 7) / 8), 0);
+		verticesWritten_ = 0;
+
+		file_.open(fileName, std::fstream::in | std::fstream::out | std::fstream::trunc | std::fstream::binary);
+		if (file_.fail()) return false;
+
+		// the header is marked as incomplete until every vertex has been written
+		char headerBlock[PRT_BINARY_HEADER_SIZE] = {};
+		memcpy(headerBlock, &header_, sizeof(header_));
+		file_.write(headerBlock, PRT_BINARY_HEADER_SIZE);
+
+		checksum_ = PRTChecksum();
+		WriteMeshSections(file_, checksum_, header_, pVertex, pIndex);
+
+		// the record is written after the end of the coefficients, which extends the file to its
+		// final size such that each range can be written in place
+		PRTStreamRecord record = { settingsKey, FinalizePRTChecksum(checksum_) };
+		file_.seekp(header_.fileSize);
+		file_.write((const char*)&record, sizeof(record));
+		file_.write((const char*)written_.data(), written_.size());
+		file_.flush();
+
+		isOpen_ = !file_.fail();
+		return isOpen_;
+	}
+
+
+	bool PRTStreamWriter::resumeFile(const float* pVertex, const UINT32* pIndex, const UINT64& settingsKey) {
+
+		file_.open(fileName_, std::fstream::in | std::fstream::out | std::fstream::binary);
+		if (file_.fail()) return false;
+
+		// the header must be the one written by Open for the same mesh and maxL
+		PRTBinaryHeader header;
+		file_.read((char*)&header, sizeof(header));
+		if (file_.fail() || memcmp(&header, &header_, sizeof(header)) != 0) return false;
+
+		written_.assign((size_t)((header_.vertexNum + 7) / 8), 0);
+		file_.seekg(0, std::fstream::end);
+		if ((UINT64)file_.tellg() != header_.fileSize + sizeof(PRTStreamRecord) + written_.size()) return false;
+
+		PRTStreamRecord record;
+		file_.seekg(header_.fileSize);
+		file_.read((char*)&record, sizeof(record));
+		file_.read((char*)written_.data(), written_.size());
+		if (file_.fail() || record.settingsKey != settingsKey) return false;
+
+		// the mesh sections are written again, as the checksum is needed by Finish, and the
+		// coefficients are only kept if the mesh has not changed
+		checksum_ = PRTChecksum();
+		file_.seekp(PRT_BINARY_HEADER_SIZE);
+		WriteMeshSections(file_, checksum_, header_, pVertex, pIndex);
+		file_.flush();
+		if (file_.fail() || FinalizePRTChecksum(checksum_) != record.meshChecksum) return false;
+
+		UINT64 verticesWritten = 0;
+		for (UINT64 i = 0; i < header_.vertexNum; ++i) {
+			if (written_[i / 8] & (1u << (i % 8))) ++verticesWritten;
+		}
+		verticesWritten_ = verticesWritten;
+		return true;
+	}
+
+
+	bool PRTStreamWriter::WriteVertices(const UINT64& begin, const UINT64& end, const float* pCoefficient) {
+
+		std::lock_guard<std::mutex> lock(mutex_);
+
+		if (!isOpen_ || begin > end || end > header_.vertexNum) return false;
+
+		file_.seekp(header_.coefficientOffset + begin * nCoefficients_ * sizeof(float));
+		file_.write((const char*)pCoefficient, (end - begin) * nCoefficients_ * sizeof(float));
+		file_.flush(); // a range is only recorded once it has reached the file
+		if (file_.fail()) return false;
+
+		// a range that is written again replaces the previous coefficients, but is only counted once
+		for (UINT64 i = begin; i < end; ++i) {
+			if (!(written_[i / 8] & (1u << (i % 8)))) {
+				written_[i / 8] |= (UINT8)(1u << (i % 8));
+				++verticesWritten_;
+			}
+		}
+		return writeRecord(begin, end);
+	}
+
+
+	bool PRTStreamWriter::writeRecord(const UINT64& begin, const UINT64& end) {
+
+		if (begin == end) return true;
+
+		UINT64 first = begin / 8, last = (end - 1) / 8;
+		file_.seekp(header_.fileSize + sizeof(PRTStreamRecord) + first);
+		file_.write((const char*)&written_[first], last - first + 1);
+		file_.flush();
+		return !file_.fail();
+	}
+
+
+	bool PRTStreamWriter::IsRangeWritten(const UINT64& begin, const UINT64& end) {
+
+		std::lock_guard<std::mutex> lock(mutex_);
+
+		if (!isOpen_ || begin > end || end > header_.vertexNum) return false;
+
+		for (UINT64 i = begin; i < end; ++i) {
+			if (!(written_[i / 8] & (1u << (i % 8)))) return false;
+		}
+		return true;
+	}
+
+
+	bool PRTStreamWriter::Finish() {
+
+		std::lock_guard<std::mutex> lock(mutex_);
+
+		if (!isOpen_ || verticesWritten_ != header_.vertexNum) return false;
+
+		// the coefficients were written out of order, so they are read back in order to complete
+		// the checksum
+		PRTChecksum checksum = checksum_;
+		std::vector<char> block(65536);
+		file_.seekg(header_.coefficientOffset);
+		for (UINT64 position = header_.coefficientOffset; position < header_.fileSize;) {
+			size_t size = (size_t)(std::min)(header_.fileSize - position, (UINT64)block.size());
+			file_.read(&block[0], size);
+			if (file_.fail()) return false;
+			UpdatePRTChecksum(checksum, &block[0], size);
+			position += size;
+		}
+		file_.close();
+		isOpen_ = false;
+
+		// the record is removed before the header is completed, such that a file interrupted in
+		// between is started again rather than resumed or read
+		std::error_code error;
+		std::filesystem::resize_file(fileName_, header_.fileSize, error);
+		if (error) return false;
+
+		PRTBinaryHeader header = header_;
+		header.flags &= ~PRT_BINARY_FLAG_INCOMPLETE;
+		header.checksum = FinalizePRTChecksum(checksum);
+		file_.open(fileName_, std::fstream::in | std::fstream::out | std::fstream::binary);
+		file_.write((const char*)&header, sizeof(header));
+		file_.close();
+
+		return !file_.fail();
+	}
+
+
+	UINT64 PRTStreamWriter::GetNumVerticesWritten() const {
+		return verticesWritten_;
+	}
+
+	UINT64 PRTStreamWriter::GetNumVertices() const {
+		return header_.vertexNum;
 	}
 
 }
\ No newline at end of file
@@ -0,0 +1,490 @@
+/*
+*
+* Implimentation of the PlyReader Class (see PlyReader.h)
+*
+*
+* Forms part of the DxPRT project
+*
+*
+*
+* Author: Shaun Bailey
+*
+* Date created: 16/10/2026
+*
+* Last Updated: 16/10/2026
+*
+*
+*
+* MIT License
+*
+* Copyright (c) 2021 Shaun Bailey
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*
+*/
+
+#include "DxPRT/PlyReader.h"
+#include "DxPRT/MappedFile.h"
+#include "DxPRT/ObjReader.h"
+#include "DxPRT/TextParsing.h"
+#include <algorithm>
+#include <cctype>
+#include <cstdint>
+#include <cstring>
+
+
+namespace DxPRT_Utility {
+
+	// returns the number of bytes of a value of the type
+	static size_t GetPlyTypeSize(const PLY_TYPE& type)
+	{
+		switch (type)
+		{
+		case PLY_TYPE_INT8:
+		case PLY_TYPE_UINT8:
+			return 1;
+		case PLY_TYPE_INT16:
+		case PLY_TYPE_UINT16:
+			return 2;
+		case PLY_TYPE_FLOAT64:
+			return 8;
+		default:
+			return 4;
+		}
+	}
+
+
+	// converts the name of a type in the header, returns false if it is not a known type
+	static bool GetPlyType(const std::string& name, PLY_TYPE& type)
+	{
+		if (name == "char" || name == "int8") type = PLY_TYPE_INT8;
+		else if (name == "uchar" || name == "uint8") type = PLY_TYPE_UINT8;
+		else if (name == "short" || name == "int16") type = PLY_TYPE_INT16;
+		else if (name == "ushort" || name == "uint16") type = PLY_TYPE_UINT16;
+		else if (name == "int" || name == "int32") type = PLY_TYPE_INT32;
+		else if (name == "uint" || name == "uint32") type = PLY_TYPE_UINT32;
+		else if (name == "float" || name == "float32") type = PLY_TYPE_FLOAT32;
+		else if (name == "double" || name == "float64") type = PLY_TYPE_FLOAT64;
+		else return false;
+		return true;
+	}
+
+
+	template<typename S, typename T>
+	static T ReadPlyScalar(const char* p)
+	{
+		S value;
+		memcpy(&value, p, sizeof(S)); // the data are not aligned
+		return (T)value;
+	}
+
+	// reads a little-endian value of the given type and converts it to T
+	template<typename T>
+	static T ReadPlyValue(const char* p, const PLY_TYPE& type)
+	{
+		switch (type)
+		{
+		case PLY_TYPE_INT8: return ReadPlyScalar<std::int8_t, T>(p);
+		case PLY_TYPE_UINT8: return ReadPlyScalar<std::uint8_t, T>(p);
+		case PLY_TYPE_INT16: return ReadPlyScalar<std::int16_t, T>(p);
+		case PLY_TYPE_UINT16: return ReadPlyScalar<std::uint16_t, T>(p);
+		case PLY_TYPE_INT32: return ReadPlyScalar<std::int32_t, T>(p);
+		case PLY_TYPE_UINT32: return ReadPlyScalar<std::uint32_t, T>(p);
+		case PLY_TYPE_FLOAT32: return ReadPlyScalar<float, T>(p);
+		default: return ReadPlyScalar<double, T>(p);
+		}
+	}
+
+
+	// returns the next token of a header line and moves p past it
+	static std::string NextPlyToken(const char*& p, const char* lineEnd)
+	{
+		const char* tokenBegin = SkipTextSpaces(p, lineEnd);
+		p = FindTokenEnd(tokenBegin, lineEnd);
+		return std::string(tokenBegin, p);
+	}
+
+
+	bool IsPlyFile(const std::string& fileName)
+	{
+		if (fileName.size() < 4) return false;
+		std::string extension = fileName.substr(fileName.size() - 4);
+		for (auto iter = extension.begin(); iter != extension.end(); ++iter)
+		{
+			*iter = (char)tolower((unsigned char)(*iter));
+		}
+		return extension == ".ply";
+	}
+
+
+	PlyReader::PlyReader(const std::string &fileName, const bool &calculateNormals)
+	{
+		this->Load(fileName, calculateNormals);
+	}
+
+	PlyReader::PlyReader() {}
+
+
+	bool PlyReader::Load(const std::string &fileName, const bool &calculateNormals)
+	{
+		// clear any previously loaded file
+		*this = PlyReader();
+		calcNormals_ = calculateNormals;
+
+		MappedFile file;
+		if (!file.Open(fileName)) return false;
+		const char* p = file.GetData();
+		const char* end = p + file.GetSize();
+
+		std::vector<PlyElement> elements;
+		if (!this->ProcessHeader(p, end, elements)) return false;
+
+		bool verticesRead = false, facesRead = false;
+		for (auto iter = elements.cbegin(); iter != elements.cend(); ++iter)
+		{
+			if (iter->name == "vertex" && !verticesRead)
+			{
+				if (!this->ReadVertices(*iter, p, end)) return false;
+				verticesRead = true;
+			}
+			else if (iter->name == "face" && !facesRead)
+			{
+				if (!this->ReadFaces(*iter, p, end)) return false;
+				facesRead = true;
+			}
+			else
+			{
+				if (!this->SkipElement(*iter, p, end)) return false;
+			}
+		}
+
+		// final checks
+		if (vertices_.size() == 0) return false;
+		if (indices_.size() == 0) return false;
+		for (auto iter = indices_.cbegin(); iter != indices_.cend(); ++iter)
+		{
+			if ((size_t)(*iter) * 3 >= vertices_.size()) return false; // index outside of vertex range
+		}
+
+		if (calcNormals_ && normals_.empty())
+		{
+			normals_.assign(vertices_.size(), 0.0f);
+			SumFaceNormals(&vertices_[0], &indices_[0], indices_.size() / 3, &normals_[0]);
+		}
+
+		isLoaded_ = true;
+		return true;
+	}
+
+
+	bool PlyReader::ProcessHeader(const char*& p, const char* end,
+		std::vector<PlyElement>& elements) const
+	{
+		const char* lineEnd = FindLineEnd(p, end);
+		if (NextPlyToken(p, lineEnd) != "ply") return false; // indicates that this is a ply file
+		p = NextLine(lineEnd, end);
+
+		bool formatFound = false;
+		while (p != end)
+		{
+			lineEnd = FindLineEnd(p, end);
+			std::string keyword = NextPlyToken(p, lineEnd);
+
+			if (keyword == "format")
+			{
+				// current itteration only accepts binary little-endian files
+				if (NextPlyToken(p, lineEnd) != "binary_little_endian") return false;
+				formatFound = true;
+			}
+			else if (keyword == "element")
+			{
+				PlyElement element;
+				element.name = NextPlyToken(p, lineEnd);
+				p = ParseTextValue(SkipTextSpaces(p, lineEnd), lineEnd, element.count);
+				if (!p || !IsTextLineEnd(p, lineEnd)) return false;
+				elements.push_back(element);
+			}
+			else if (keyword == "property")
+			{
+				if (elements.empty()) return false;
+				PlyProperty property;
+				std::string type = NextPlyToken(p, lineEnd);
+				if (type == "list")
+				{
+					property.isList = true;
+					if (!GetPlyType(NextPlyToken(p, lineEnd), property.countType)) return false;
+					type = NextPlyToken(p, lineEnd);
+				}
+				if (!GetPlyType(type, property.type)) return false;
+				property.name = NextPlyToken(p, lineEnd);
+				if (property.name.empty()) return false;
+				elements.back().properties.push_back(property);
+			}
+			else if (keyword == "end_header")
+			{
+				p = NextLine(lineEnd, end);
+				return formatFound;
+			}
+			// comments and obj_info are ignored
+
+			p = NextLine(lineEnd, end);
+		}
+		return false;
+	}
+
+
+	bool PlyReader::ReadVertices(const PlyElement& element, const char*& p, const char* end)
+	{
+		// the offset of each of x, y, z, nx, ny and nz within a vertex
+		const char* names[6] = { "x", "y", "z", "nx", "ny", "nz" };
+		size_t offsets[6] = {};
+		PLY_TYPE types[6] = {};
+		bool found[6] = {};
+
+		size_t stride = 0;
+		for (auto iter = element.properties.cbegin(); iter != element.properties.cend(); ++iter)
+		{
+			if (iter->isList) return false;
+			for (int i = 0; i < 6; ++i)
+			{
+				if (iter->name == names[i])
+				{
+					offsets[i] = stride;
+					types[i] = iter->type;
+					found[i] = true;
+				}
+			}
+			stride += GetPlyTypeSize(iter->type);
+		}
+		if (!found[0] || !found[1] || !found[2]) return false;
+		if (element.count > (size_t)(end - p) / stride) return false;
+
+		size_t vertexNum = element.count;
+		vertices_.resize(vertexNum * 3);
+		bool isFloat = types[0] == PLY_TYPE_FLOAT32 && types[1] == PLY_TYPE_FLOAT32 &&
+			types[2] == PLY_TYPE_FLOAT32;
+		if (isFloat && offsets[1] == offsets[0] + 4 && offsets[2] == offsets[0] + 8)
+		{
+			// the usual layout, each position is a single copy
+			for (size_t i = 0; i < vertexNum; ++i)
+			{
+				memcpy(&vertices_[i * 3], p + i * stride + offsets[0], 3 * sizeof(float));
+			}
+		}
+		else
+		{
+			for (size_t i = 0; i < vertexNum; ++i)
+			{
+				for (int j = 0; j < 3; ++j)
+				{
+					vertices_[i * 3 + j] = ReadPlyValue<float>(p + i * stride + offsets[j], types[j]);
+				}
+			}
+		}
+
+		if (calcNormals_ && found[3] && found[4] && found[5])
+		{
+			normals_.resize(vertexNum * 3);
+			for (size_t i = 0; i < vertexNum; ++i)
+			{
+				for (int j = 0; j < 3; ++j)
+				{
+					normals_[i * 3 + j] = ReadPlyValue<float>(p + i * stride + offsets[3 + j], types[3 + j]);
+				}
+			}
+		}
+
+		p += vertexNum * stride;
+		return true;
+	}
+
+
+	bool PlyReader::ReadFaces(const PlyElement& element, const char*& p, const char* end)
+	{
+		auto indexProperty = std::find_if(element.properties.cbegin(), element.properties.cend(),
+			[](const PlyProperty& property) {
+				return property.isList &&
+					(property.name == "vertex_indices" || property.name == "vertex_index");
+			});
+		if (indexProperty == element.properties.cend()) return false;
+
+		size_t indexSize = GetPlyTypeSize(indexProperty->type);
+		bool isUINT32 = indexProperty->type == PLY_TYPE_INT32 || indexProperty->type == PLY_TYPE_UINT32;
+
+		// assumes that the faces are triangles, polygons will grow the vector
+		indices_.reserve((std::min)(element.count, (UINT64)(end - p)) * 3);
+
+		for (UINT64 iFace = 0; iFace < element.count; ++iFace)
+		{
+			for (auto iter = element.properties.cbegin(); iter != element.properties.cend(); ++iter)
+			{
+				size_t countSize = GetPlyTypeSize(iter->countType);
+				size_t valueSize = GetPlyTypeSize(iter->type);
+				if (!iter->isList)
+				{
+					if ((size_t)(end - p) < valueSize) return false;
+					p += valueSize;
+					continue;
+				}
+
+				if ((size_t)(end - p) < countSize) return false;
+				UINT64 count = ReadPlyValue<UINT64>(p, iter->countType);
+				p += countSize;
+				if (count > (size_t)(end - p) / valueSize) return false;
+
+				if (iter == indexProperty)
+				{
+					if (count < 3) return false;
+					size_t start = indices_.size();
+					indices_.resize(start + (count - 2) * 3);
+					UINT32* indices = &indices_[start];
+
+					if (count == 3 && isUINT32)
+					{
+						memcpy(indices, p, 3 * sizeof(UINT32));
+					}
+					else
+					{
+						// more that 3 vertices in face share the first vertex
+						UINT32 first = ReadPlyValue<UINT32>(p, iter->type);
+						for (UINT64 i = 2; i < count; ++i)
+						{
+							indices[0] = first;
+							indices[1] = ReadPlyValue<UINT32>(p + (i - 1) * indexSize, iter->type);
+							indices[2] = ReadPlyValue<UINT32>(p + i * indexSize, iter->type);
+							indices += 3;
+						}
+					}
+				}
+				p += count * valueSize;
+			}
+		}
+		return true;
+	}
+
+
+	bool PlyReader::SkipElement(const PlyElement& element, const char*& p, const char* end) const
+	{
+		for (UINT64 i = 0; i < element.count; ++i)
+		{
+			for (auto iter = element.properties.cbegin(); iter != element.properties.cend(); ++iter)
+			{
+				UINT64 count = 1;
+				if (iter->isList)
+				{
+					size_t countSize = GetPlyTypeSize(iter->countType);
+					if ((size_t)(end - p) < countSize) return false;
+					count = ReadPlyValue<UINT64>(p, iter->countType);
+					p += countSize;
+				}
+				size_t valueSize = GetPlyTypeSize(iter->type);
+				if (count > (size_t)(end - p) / valueSize) return false;
+				p += count * valueSize;
+			}
+		}
+		return true;
+	}
+
+
+	float* PlyReader::GetVertices()
+	{
+		if (isLoaded_)
+		{
+			return &vertices_[0];
+		}
+		else
+		{
+			this->NotLoadedMessage();
+			return nullptr;
+		}
+	}
+
+	UINT32* PlyReader::GetIndices()
+	{
+		if (isLoaded_)
+		{
+			return &indices_[0];
+		}
+		else
+		{
+			this->NotLoadedMessage();
+			return nullptr;
+		}
+	}
+
+	float* PlyReader::GetNormals()
+	{
+		if (isLoaded_ && calcNormals_)
+		{
+			return &normals_[0];
+		}
+		else
+		{
+			this->NotLoadedMessage();
+			return nullptr;
+		}
+	}
+
+	size_t PlyReader::GetSizeVertices() const
+	{
+		if (isLoaded_)
+		{
+			return vertices_.size();
+		}
+		else
+		{
+			this->NotLoadedMessage();
+			return 0;
+		}
+	}
+
+	size_t PlyReader::GetSizeIndices() const
+	{
+		if (isLoaded_)
+		{
+			return indices_.size();
+		}
+		else
+		{
+			this->NotLoadedMessage();
+			return 0;
+		}
+	}
+
+	size_t PlyReader::GetSizeNormals() const
+	{
+		if (isLoaded_ && calcNormals_)
+		{
+			return normals_.size();
+		}
+		else
+		{
+			this->NotLoadedMessage();
+			return 0;
+		}
+	}
+
+
+	void PlyReader::NotLoadedMessage() const
+	{
+		OutputDebugStringA("DxPRT: Ply file is not loaded, cannot access data!\n");
+		throw std::exception();
+	}
+
+}
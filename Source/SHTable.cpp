@@ -0,0 +1,203 @@
+/*
+*
+* Implimentation of the SHTable Class (see SHTable.h)
+*
+*
+* Forms part of the DxPRT project
+*
+*
+*
+* Author: Shaun Bailey
+*
+* Date created: 16/10/2026
+*
+* Last Updated: 16/10/2026
+*
+*
+*
+* MIT License
+*
+* Copyright (c) 2021 Shaun Bailey
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*
+*/
+
+#include "DxPRT/SHTable.h"
+#include "DxPRT/SphericalHarmonics.h"
+#include "DxPRT/ThreadPool.h"
+#include <algorithm>
+#include <cmath>
+#include <mutex>
+
+
+namespace DxPRT_Utility {
+
+	// the tables shared between calls (see GetShared), which are freed once no call holds them
+	static std::mutex& SharedTableMutex()
+	{
+		static std::mutex mutex;
+		return mutex;
+	}
+
+	static std::vector<std::weak_ptr<const SHTable>>& SharedTables()
+	{
+		static std::vector<std::weak_ptr<const SHTable>> tables;
+		return tables;
+	}
+
+
+	// returns the shared table of the given size if it is still in use, and removes the expired tables.
+	// The mutex must be held by the caller
+	static std::shared_ptr<const SHTable> FindSharedTable(const UINT64& shGridNum, const UINT64& maxL)
+	{
+		std::vector<std::weak_ptr<const SHTable>>& tables = SharedTables();
+		tables.erase(std::remove_if(tables.begin(), tables.end(),
+			[](const std::weak_ptr<const SHTable>& table) { return table.expired(); }), tables.end());
+
+		for (const std::weak_ptr<const SHTable>& weakTable : tables)
+		{
+			std::shared_ptr<const SHTable> table = weakTable.lock();
+			if (table && table->Matches(shGridNum, maxL)) return table;
+		}
+		return nullptr;
+	}
+
+
+	SHTable::SHTable() {}
+
+	SHTable::SHTable(const UINT64& shGridNum, const UINT64& maxL, const UINT64& numThreads)
+	{
+		this->Build(shGridNum, maxL, numThreads);
+	}
+
+
+	void SHTable::Build(const UINT64& shGridNum, const UINT64& maxL, const UINT64& numThreads)
+	{
+		const float PI = 3.14159265f;
+
+		shGridNum_ = shGridNum;
+		maxL_ = maxL;
+		nCoefficients_ = (maxL + 1) * (maxL + 1);
+		const UINT64 gridSize = shGridNum * shGridNum;
+		data_.resize(nCoefficients_ * gridSize);
+
+		// theta at the texel centres is the same for every row
+		std::vector<float> ctheta(shGridNum);
+		for (UINT64 j = 0; j < shGridNum; ++j)
+		{
+			ctheta[j] = cos(PI * (float(j) + 0.5f) / float(shGridNum));
+		}
+
+		ThreadPool threadPool(numThreads);
+
+		// each thread evaluates a row at a time into its own buffer, which is then copied into the grids
+		std::vector<std::vector<float>> phi(threadPool.GetNumThreads());
+		std::vector<std::vector<float>> sh(threadPool.GetNumThreads());
+
+		threadPool.ParallelFor(shGridNum, 0, [&](UINT64 iThread, UINT64 begin, UINT64 end)
+		{
+			phi[iThread].resize(shGridNum);
+			sh[iThread].resize(nCoefficients_ * shGridNum);
+
+			for (UINT64 i = begin; i < end; ++i)
+			{
+				std::fill(phi[iThread].begin(), phi[iThread].end(), 2.0f * PI * (float(i) + 0.5f) / float(shGridNum));
+				CalcSHAngles(maxL, shGridNum, &ctheta[0], &phi[iThread][0], &sh[iThread][0]);
+
+				for (UINT64 k = 0; k < nCoefficients_; ++k)
+				{
+					std::copy(sh[iThread].begin() + k * shGridNum, sh[iThread].begin() + (k + 1) * shGridNum,
+						data_.begin() + k * gridSize + i * shGridNum);
+				}
+			}
+		});
+
+		isBuilt_ = true;
+	}
+
+
+	std::shared_ptr<const SHTable> SHTable::GetShared(const UINT64& shGridNum, const UINT64& maxL)
+	{
+		{
+			std::lock_guard<std::mutex> lock(SharedTableMutex());
+			std::shared_ptr<const SHTable> table = FindSharedTable(shGridNum, maxL);
+			if (table) return table;
+		}
+
+		std::shared_ptr<const SHTable> table = std::make_shared<const SHTable>(shGridNum, maxL);
+
+		// another call may have built the same table in the meantime, in which case that table is kept
+		std::lock_guard<std::mutex> lock(SharedTableMutex());
+		std::shared_ptr<const SHTable> sharedTable = FindSharedTable(shGridNum, maxL);
+		if (sharedTable) return sharedTable;
+		SharedTables().push_back(table);
+		return table;
+	}
+
+	std::shared_ptr<const SHTable> SHTable::GetShared(const UINT64& shGridNum, const UINT64& maxL,
+		const std::shared_ptr<const SHTable>& table)
+	{
+		if (table && table->Matches(shGridNum, maxL)) return table;
+		if (table) OutputDebugStringA("DxPRT: The spherical harmonic table provided does not match SHGridNum"
+			" and MaxL, a new table is built instead.\n");
+		return GetShared(shGridNum, maxL);
+	}
+
+
+	bool SHTable::Matches(const UINT64& shGridNum, const UINT64& maxL) const
+	{
+		return isBuilt_ && shGridNum_ == shGridNum && maxL_ == maxL;
+	}
+
+
+	const float* SHTable::GetGrid(const UINT64& iCoefficient) const
+	{
+		if (isBuilt_ && iCoefficient < nCoefficients_) return &data_[iCoefficient * shGridNum_ * shGridNum_];
+		else
+		{
+			this->NotBuiltMessage();
+			return nullptr;
+		}
+	}
+
+
+	UINT64 SHTable::GetSHGridNum() const
+	{
+		return shGridNum_;
+	}
+
+	UINT64 SHTable::GetMaxL() const
+	{
+		return maxL_;
+	}
+
+	UINT64 SHTable::GetNCoefficients() const
+	{
+		return nCoefficients_;
+	}
+
+
+	void SHTable::NotBuiltMessage() const
+	{
+		OutputDebugStringA("DxPRT: Spherical harmonic table is not built, cannot access data!\n");
+		throw std::exception();
+	}
+
+}
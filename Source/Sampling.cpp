@@ -0,0 +1,229 @@
+/*
+*
+* Implimentation of Sampling.h
+*
+*
+* Forms part of the DxPRT project
+*
+*
+*
+* Author: Shaun Bailey
+*
+* Date created: 16/10/2026
+*
+* Last Updated: 16/10/2026
+*
+*
+*
+* MIT License
+*
+* Copyright (c) 2021 Shaun Bailey
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*
+*/
+
+#include "DxPRT/Sampling.h"
+#include <cmath>
+
+using namespace DxPRT;
+
+namespace DxPRT_Utility {
+
+    // the counter of the scramble of a stream uses a different domain to the events
+    static const UINT32 EVENT_DOMAIN = 0;
+    static const UINT32 SCRAMBLE_DOMAIN = 1;
+
+
+    // returns the high and low 32 bits of the product of a and b
+    static void MultiplyHighLow(const UINT32& a, const UINT32& b, UINT32& high, UINT32& low) {
+        UINT64 product = UINT64(a) * UINT64(b);
+        high = UINT32(product >> 32);
+        low = UINT32(product);
+    }
+
+
+    static UINT32 ReverseBits(UINT32 x) {
+        x = ((x >> 1) & 0x55555555u) | ((x & 0x55555555u) << 1);
+        x = ((x >> 2) & 0x33333333u) | ((x & 0x33333333u) << 2);
+        x = ((x >> 4) & 0x0f0f0f0fu) | ((x & 0x0f0f0f0fu) << 4);
+        x = ((x >> 8) & 0x00ff00ffu) | ((x & 0x00ff00ffu) << 8);
+        return (x >> 16) | (x << 16);
+    }
+
+
+    // hash that only affects higher bits based on lower bits, applied to the reversed bits this
+    // randomly permutes the intervals at every level of the binary tree (Owen scrambling)
+    static UINT32 LaineKarrasPermutation(UINT32 x, const UINT32& seed) {
+        x ^= x * 0x3d20adeau;
+        x += seed;
+        x *= (seed >> 16) | 1u;
+        x ^= x * 0x05526c56u;
+        x ^= x * 0x53a22864u;
+        return x;
+    }
+
+
+    static UINT32 NestedUniformScramble(const UINT32& x, const UINT32& seed) {
+        return ReverseBits(LaineKarrasPermutation(ReverseBits(x), seed));
+    }
+
+
+    // the top 24 bits mapped to [0, 1), such that the result is never rounded up to 1
+    static float ToUnitFloat(const UINT32& x) {
+        return float(x >> 8) * (1.0f / 16777216.0f);
+    }
+
+
+    static UINT64 GreatestCommonDivisor(UINT64 a, UINT64 b) {
+        while (b != 0) {
+            UINT64 r = a % b;
+            a = b;
+            b = r;
+        }
+        return a;
+    }
+
+
+    RandomStream InitializeRandomStream(const UINT64& seed, const UINT64& stream) {
+        RandomStream randomStream;
+        randomStream.key[0] = UINT32(seed);
+        randomStream.key[1] = UINT32(seed >> 32);
+        randomStream.stream = UINT32(stream);
+        return randomStream;
+    }
+
+
+    void Philox(const UINT32* counter, const UINT32* key, UINT32* result) {
+        UINT32 c[4] = { counter[0], counter[1], counter[2], counter[3] };
+        UINT32 k[2] = { key[0], key[1] };
+
+        for (int round = 0; round < 10; ++round) {
+            UINT32 high0, low0, high1, low1;
+            MultiplyHighLow(0xD2511F53u, c[0], high0, low0);
+            MultiplyHighLow(0xCD9E8D57u, c[2], high1, low1);
+            UINT32 next[4] = { high1 ^ c[1] ^ k[0], low1, high0 ^ c[3] ^ k[1], low0 };
+            for (int i = 0; i < 4; ++i) {
+                c[i] = next[i];
+            }
+            k[0] += 0x9E3779B9u; // Weyl sequence for the key schedule
+            k[1] += 0xBB67AE85u;
+        }
+
+        for (int i = 0; i < 4; ++i) {
+            result[i] = c[i];
+        }
+    }
+
+
+    void RandomIntegers(const RandomStream& stream, const UINT64& index, UINT32* result) {
+        UINT32 counter[4] = { UINT32(index), UINT32(index >> 32), stream.stream, EVENT_DOMAIN };
+        Philox(counter, stream.key, result);
+    }
+
+
+    void RandomNumbers(const RandomStream& stream, const UINT64& index, float& random1, float& random2) {
+        UINT32 result[4];
+        RandomIntegers(stream, index, result);
+        random1 = ToUnitFloat(result[0]);
+        random2 = ToUnitFloat(result[1]);
+    }
+
+
+    SampleScramble InitializeScramble(const RandomStream& stream) {
+        UINT32 counter[4] = { 0, 0, stream.stream, SCRAMBLE_DOMAIN };
+        UINT32 result[4];
+        Philox(counter, stream.key, result);
+
+        SampleScramble scramble;
+        scramble.seed[0] = result[0];
+        scramble.seed[1] = result[1];
+        scramble.shift[0] = ToUnitFloat(result[2]);
+        scramble.shift[1] = ToUnitFloat(result[3]);
+        return scramble;
+    }
+
+
+    void SobolSample(const UINT32& index, const SampleScramble& scramble, float& random1, float& random2) {
+
+        // the first dimension is the van der Corput sequence, the second uses the direction numbers
+        // of the primitive polynomial x + 1, which satisfy v[i] = v[i - 1] ^ (v[i - 1] >> 1)
+        UINT32 x = ReverseBits(index);
+        UINT32 y = 0, v = 0x80000000u;
+        for (UINT32 i = index; i != 0; i >>= 1) {
+            if (i & 1u) y ^= v;
+            v ^= v >> 1;
+        }
+
+        random1 = ToUnitFloat(NestedUniformScramble(x, scramble.seed[0]));
+        random2 = ToUnitFloat(NestedUniformScramble(y, scramble.seed[1]));
+    }
+
+
+    void LatticeSample(const UINT64& index, const UINT64& count, const UINT64& generator,
+        const SampleScramble& scramble, float& random1, float& random2) {
+
+        double x = double(index) / double(count) + scramble.shift[0];
+        double y = double((index * generator) % count) / double(count) + scramble.shift[1];
+
+        random1 = float(x - floor(x));
+        random2 = float(y - floor(y));
+        // rounding may give exactly 1
+        if (random1 >= 1.0f) random1 = 0.0f;
+        if (random2 >= 1.0f) random2 = 0.0f;
+    }
+
+
+    UINT64 LatticeGenerator(const UINT64& count) {
+        if (count <= 2) return 1;
+
+        const double goldenRatio = 1.6180339887498949;
+        UINT64 target = UINT64(double(count) / goldenRatio + 0.5);
+
+        // search outwards from the target for an integer coprime with count
+        for (UINT64 offset = 0; offset < count; ++offset) {
+            if (target + offset < count && GreatestCommonDivisor(target + offset, count) == 1) {
+                return target + offset;
+            }
+            if (offset <= target && target - offset > 0 && GreatestCommonDivisor(target - offset, count) == 1) {
+                return target - offset;
+            }
+        }
+        return 1;
+    }
+
+
+    void DrawSample(const SAMPLING_MODE& mode, const UINT64& index, const UINT64& count,
+        const UINT64& generator, const SampleScramble& scramble, const RandomStream& stream,
+        float& random1, float& random2) {
+
+        switch (mode) {
+        case SAMPLING_SOBOL:
+            SobolSample((UINT32)index, scramble, random1, random2);
+            break;
+        case SAMPLING_LATTICE:
+            LatticeSample(index, count, generator, scramble, random1, random2);
+            break;
+        default:
+            RandomNumbers(stream, index, random1, random2);
+            break;
+        }
+    }
+
+}
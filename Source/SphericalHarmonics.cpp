@@ -39,6 +39,9 @@
 */
 
 #include "DxPRT/SphericalHarmonics.h"
+#include "DxPRT/SHEval.h"
+#include <algorithm>
+#include <cmath>
 
 
 namespace DxPRT_Utility {
@@ -46,46 +49,222 @@ namespace DxPRT_Utility {
 	std::vector<float> CalcSH(const size_t& N, const float& ctheta,
 		const float& phi) 
 	{
-
 		std::vector<float> SHvec((N + 1ull) * (N + 1ull), 0.0f);
+		CalcSH(N, ctheta, phi, &SHvec[0]);
+		return SHvec;
+	}
+
+
+	void CalcSH(const size_t& N, const float& ctheta, const float& phi, float* result)
+	{
+		// direction with the global coordinates used by the shaders, phi = atan2(z, x) + pi
+		float stheta = sqrt((std::max)(0.0f, 1.0f - ctheta * ctheta));
+		CalcSHDirection(N, -stheta * cos(phi), ctheta, -stheta * sin(phi), result);
+	}
+
+
+	// normalization of the spherical harmonic with the given l and m >= 0, as in CalcCoefficient
+	static float SHNormalization(const long long& l, const long long& m)
+	{
+		static const double PI = 3.14159265358979;
+		double res = (2.0 * l + 1.0) / (4.0 * PI);
+		for (long long k = l - m + 1; k <= l + m; ++k)
+		{
+			res /= double(k);
+		}
+		return float(sqrt(res));
+	}
+
+
+	// the recurrences for any N, vectorized over blocks of directions by the compiler. The value
+	// of spherical harmonic k for direction i is stored at result[k * stride + i]
+	static void CalcSHDirectionsGeneral(const size_t& N, const size_t& count, const size_t& stride,
+		const float* x, const float* y, const float* z, float* result)
+	{
+		const size_t BLOCK_SIZE = 64;
+		const float SQRT2 = 1.41421356f;
 
-		// calculate Legendre polynomials
-		for (long long  l = 0; l <= N; ++l)
+		for (size_t begin = 0; begin < count; begin += BLOCK_SIZE)
 		{
-			for (long long m = l; m >= 0; --m)
+			size_t n = (std::min)(BLOCK_SIZE, count - begin);
+			const float* xBlock = x + begin;
+			const float* yBlock = y + begin;
+			const float* zBlock = z + begin;
+			float* resultBlock = result + begin;
+
+			// sin(theta)^m cos(m phi) and sin(theta)^m sin(m phi), the real and imaginary parts
+			// of (-x - iz)^m, and the Legendre function divided by sin(theta)^m
+			float cosine[BLOCK_SIZE], sine[BLOCK_SIZE];
+			float Pmm[BLOCK_SIZE], P1[BLOCK_SIZE], P2[BLOCK_SIZE];
+			for (size_t i = 0; i < n; ++i)
 			{
-				float res;
-				if (l == m) 
-				{
-					res = CalcLegendre1(m, ctheta);
-				}
-				else if (l == m + 1) 
+				cosine[i] = 1.0f;
+				sine[i] = 0.0f;
+				Pmm[i] = 1.0f;
+			}
+
+			for (long long m = 0; m <= (long long)N; ++m)
+			{
+				if (m > 0)
 				{
-					float P1 = SHvec[m * m + 2ull * m];
-					res = CalcLegendre2(m, ctheta, P1);
+					for (size_t i = 0; i < n; ++i)
+					{
+						float c = cosine[i];
+						cosine[i] = -c * xBlock[i] + sine[i] * zBlock[i];
+						sine[i] = -sine[i] * xBlock[i] - c * zBlock[i];
+						Pmm[i] *= -float(2 * m - 1); // CalcLegendre1
+					}
 				}
-				else 
+
+				for (long long l = m; l <= (long long)N; ++l)
 				{
-					float P1 = SHvec[l * l - l +m];
-					float P2 = SHvec[l * l - 3ull * l + m + 2ull];
-					res = CalcLegendre3(l, m, ctheta, P1, P2);
+					float* P = (l == m) ? Pmm : P1;
+					if (l == m + 1) // CalcLegendre2
+					{
+						for (size_t i = 0; i < n; ++i)
+						{
+							P2[i] = Pmm[i];
+							P1[i] = yBlock[i] * float(2 * m + 1) * Pmm[i];
+						}
+					}
+					else if (l > m + 1) // CalcLegendre3
+					{
+						for (size_t i = 0; i < n; ++i)
+						{
+							float res = (yBlock[i] * float(2 * l - 1) * P1[i] - float(l + m - 1) * P2[i])
+								/ float(l - m);
+							P2[i] = P1[i];
+							P1[i] = res;
+						}
+					}
+
+					float K = SHNormalization(l, m);
+					if (m == 0)
+					{
+						float* Y = resultBlock + (l * l + l) * stride;
+						for (size_t i = 0; i < n; ++i)
+						{
+							Y[i] = K * P[i];
+						}
+					}
+					else
+					{
+						K *= SQRT2;
+						float* Ypositive = resultBlock + (l * l + l + m) * stride;
+						float* Ynegative = resultBlock + (l * l + l - m) * stride;
+						for (size_t i = 0; i < n; ++i)
+						{
+							Ypositive[i] = K * P[i] * cosine[i];
+							Ynegative[i] = K * P[i] * sine[i];
+						}
+					}
 				}
-				SHvec[l * l + l + m] = res;
 			}
 		}
+	}
+
+
+	// the evaluator specialized for L, SIMD_WIDTH directions at a time
+	template <size_t L>
+	static void CalcSHDirectionsSpecialized(const size_t& count, const size_t& stride,
+		const float* x, const float* y, const float* z, float* result)
+	{
+		const size_t nCoefficients = (L + 1) * (L + 1);
 
-		// apply coefficient
-		for (long long l = 0; l <= N; ++l)
+		SIMDFloat sh[nCoefficients];
+		size_t i = 0;
+		for (; i + SIMD_WIDTH <= count; i += SIMD_WIDTH)
 		{
-			for (long long m = -(int)l; m <= l; ++m) 
+			SHEval<L>(SIMDLoad(x + i), SIMDLoad(y + i), SIMDLoad(z + i), sh);
+			for (size_t k = 0; k < nCoefficients; ++k)
 			{
-				SHvec[l * l + l + m] = CalcCoefficient(l, m, phi) * SHvec[l * l + l + abs(m)];
+				SIMDStore(result + k * stride + i, sh[k]);
 			}
 		}
 
-		return SHvec;
+		// remaining directions
+		float shSingle[nCoefficients];
+		for (; i < count; ++i)
+		{
+			SHEval<L>(x[i], y[i], z[i], shSingle);
+			for (size_t k = 0; k < nCoefficients; ++k)
+			{
+				result[k * stride + i] = shSingle[k];
+			}
+		}
+	}
+
+
+	static void CalcSHDirectionsStrided(const size_t& N, const size_t& count, const size_t& stride,
+		const float* x, const float* y, const float* z, float* result)
+	{
+		switch (N)
+		{
+		case 0: CalcSHDirectionsSpecialized<0>(count, stride, x, y, z, result); break;
+		case 1: CalcSHDirectionsSpecialized<1>(count, stride, x, y, z, result); break;
+		case 2: CalcSHDirectionsSpecialized<2>(count, stride, x, y, z, result); break;
+		case 3: CalcSHDirectionsSpecialized<3>(count, stride, x, y, z, result); break;
+		case 4: CalcSHDirectionsSpecialized<4>(count, stride, x, y, z, result); break;
+		case 5: CalcSHDirectionsSpecialized<5>(count, stride, x, y, z, result); break;
+		case 6: CalcSHDirectionsSpecialized<6>(count, stride, x, y, z, result); break;
+		case 7: CalcSHDirectionsSpecialized<7>(count, stride, x, y, z, result); break;
+		case 8: CalcSHDirectionsSpecialized<8>(count, stride, x, y, z, result); break;
+		default: CalcSHDirectionsGeneral(N, count, stride, x, y, z, result); break;
+		}
+	}
+
+
+	void CalcSHDirections(const size_t& N, const size_t& count, const float* x, const float* y,
+		const float* z, float* result)
+	{
+		CalcSHDirectionsStrided(N, count, count, x, y, z, result);
+	}
+
+
+	void CalcSHAngles(const size_t& N, const size_t& count, const float* ctheta, const float* phi,
+		float* result)
+	{
+		const size_t BLOCK_SIZE = 256;
+		float x[BLOCK_SIZE], y[BLOCK_SIZE], z[BLOCK_SIZE];
+
+		for (size_t begin = 0; begin < count; begin += BLOCK_SIZE)
+		{
+			size_t n = (std::min)(BLOCK_SIZE, count - begin);
+
+			// direction with the global coordinates used by the shaders, phi = atan2(z, x) + pi
+			for (size_t i = 0; i < n; ++i)
+			{
+				float c = ctheta[begin + i];
+				float stheta = sqrt((std::max)(0.0f, 1.0f - c * c));
+				x[i] = -stheta * cos(phi[begin + i]);
+				y[i] = c;
+				z[i] = -stheta * sin(phi[begin + i]);
+			}
+
+			CalcSHDirectionsStrided(N, n, count, x, y, z, result + begin);
+		}
 	}
 
+
+	void CalcSHDirection(const size_t& N, const float& x, const float& y, const float& z,
+		float* result)
+	{
+		switch (N)
+		{
+		case 0: SHEval<0>(x, y, z, result); break;
+		case 1: SHEval<1>(x, y, z, result); break;
+		case 2: SHEval<2>(x, y, z, result); break;
+		case 3: SHEval<3>(x, y, z, result); break;
+		case 4: SHEval<4>(x, y, z, result); break;
+		case 5: SHEval<5>(x, y, z, result); break;
+		case 6: SHEval<6>(x, y, z, result); break;
+		case 7: SHEval<7>(x, y, z, result); break;
+		case 8: SHEval<8>(x, y, z, result); break;
+		default: CalcSHDirectionsGeneral(N, 1, 1, &x, &y, &z, result); break;
+		}
+	}
+
+
 	// l = m
 	float CalcLegendre1(const long long& m, const float& x)
 	{
@@ -0,0 +1,99 @@
+/*
+*
+* Implimentation of TextParsing.h
+*
+*
+* Forms part of the DxPRT project
+*
+*
+*
+* Author: Shaun Bailey
+*
+* Date created: 16/10/2026
+*
+* Last Updated: 16/10/2026
+*
+*
+*
+* MIT License
+*
+* Copyright (c) 2021 Shaun Bailey
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*
+*/
+
+#include "DxPRT/TextParsing.h"
+#include <algorithm>
+#include <cstring>
+
+
+namespace DxPRT_Utility {
+
+	const char* FindLineEnd(const char* p, const char* end)
+	{
+		const char* lineEnd = (const char*)memchr(p, '\n', end - p);
+		return lineEnd ? lineEnd : end;
+	}
+
+
+	const char* NextLine(const char* lineEnd, const char* end)
+	{
+		return lineEnd == end ? end : lineEnd + 1;
+	}
+
+
+	const char* SkipTextSpaces(const char* p, const char* lineEnd)
+	{
+		while (p != lineEnd && IsTextSpace(*p)) ++p;
+		return p;
+	}
+
+
+	bool IsTextLineEnd(const char* p, const char* lineEnd)
+	{
+		return SkipTextSpaces(p, lineEnd) == lineEnd;
+	}
+
+
+	const char* FindTokenEnd(const char* p, const char* lineEnd)
+	{
+		while (p != lineEnd && !IsTextSpace(*p)) ++p;
+		return p;
+	}
+
+
+	std::vector<const char*> SplitTextLines(const char* data, const size_t& size,
+		const UINT64& numThreads)
+	{
+		UINT64 chunkNum = (std::min)((std::max)(numThreads, (UINT64)1) * 4, size / TEXT_CHUNK_SIZE + 1);
+
+		std::vector<const char*> bounds(chunkNum + 1);
+		const char* end = data + size;
+		bounds[0] = data;
+		for (UINT64 i = 0; i < chunkNum; ++i)
+		{
+			const char* chunkEnd = (std::max)(bounds[i], data + size * (i + 1) / chunkNum);
+			if (chunkEnd != end) chunkEnd = NextLine(FindLineEnd(chunkEnd, end), end);
+			bounds[i + 1] = chunkEnd;
+		}
+		return bounds;
+	}
+
+}
@@ -0,0 +1,238 @@
+/*
+*
+* Implimentation of the ThreadPool Class (see ThreadPool.h)
+*
+*
+* Forms part of the DxPRT project
+*
+*
+*
+* Author: Shaun Bailey
+*
+* Date created: 16/10/2026
+*
+* Last Updated: 16/10/2026
+*
+*
+*
+* MIT License
+*
+* Copyright (c) 2021 Shaun Bailey
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*
+*/
+
+#include "DxPRT/ThreadPool.h"
+#include <algorithm>
+
+
+namespace DxPRT_Utility {
+
+	ThreadPool::ThreadPool() {}
+
+	ThreadPool::ThreadPool(const UINT64& numThreads)
+	{
+		this->Initialize(numThreads);
+	}
+
+	ThreadPool::~ThreadPool()
+	{
+		this->Shutdown();
+	}
+
+
+	void ThreadPool::Initialize(const UINT64& numThreads)
+	{
+		this->Shutdown();
+
+		numThreads_ = numThreads;
+		if (numThreads_ == 0) numThreads_ = std::thread::hardware_concurrency();
+		if (numThreads_ == 0) numThreads_ = 1; // hardware_concurrency may not be known
+
+		queues_.clear();
+		for (UINT64 i = 0; i < numThreads_; ++i)
+		{
+			queues_.push_back(std::make_unique<WorkQueue>());
+		}
+
+		// the calling thread takes the final index
+		stop_ = false;
+		workers_.reserve(numThreads_ - 1);
+		for (UINT64 i = 0; i < numThreads_ - 1; ++i)
+		{
+			workers_.emplace_back(&ThreadPool::WorkerLoop, this, i);
+		}
+	}
+
+
+	void ThreadPool::ParallelFor(const UINT64& count, const UINT64& grainSize,
+		const std::function<void(UINT64, UINT64, UINT64)>& func)
+	{
+		if (count == 0) return;
+
+		if (numThreads_ <= 1)
+		{
+			// the ranges still respect the grain size, as func may rely on it
+			UINT64 step = grainSize == 0 ? count : grainSize;
+			for (UINT64 begin = 0; begin < count; begin += step)
+			{
+				func(0, begin, (std::min)(count, begin + step));
+			}
+			return;
+		}
+
+		UINT64 grain = grainSize;
+		if (grain == 0) grain = (std::max)(UINT64(1), count / (numThreads_ * 16));
+		UINT64 numRanges = (count + grain - 1) / grain;
+
+		// each thread receives a contiguous block of ranges
+		pendingRanges_ = numRanges;
+		for (UINT64 iRange = 0; iRange < numRanges; ++iRange)
+		{
+			UINT64 iThread = iRange * numThreads_ / numRanges;
+			queues_[iThread]->ranges.emplace_back(iRange * grain, (std::min)(count, (iRange + 1) * grain));
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			job_ = &func;
+			exception_ = nullptr;
+			++generation_;
+		}
+		workCondition_.notify_all();
+
+		this->RunRanges(numThreads_ - 1);
+
+		std::exception_ptr exception;
+		{
+			std::unique_lock<std::mutex> lock(mutex_);
+			doneCondition_.wait(lock, [this] { return pendingRanges_ == 0 && busyWorkers_ == 0; });
+			job_ = nullptr;
+			exception = exception_;
+			exception_ = nullptr;
+		}
+
+		if (exception) std::rethrow_exception(exception);
+	}
+
+
+	UINT64 ThreadPool::GetNumThreads() const
+	{
+		return numThreads_;
+	}
+
+
+	void ThreadPool::WorkerLoop(const UINT64& iThread)
+	{
+		UINT64 generation = 0;
+		while (true)
+		{
+			{
+				std::unique_lock<std::mutex> lock(mutex_);
+				workCondition_.wait(lock, [&] { return stop_ || (job_ != nullptr && generation_ != generation); });
+				if (stop_) return;
+				generation = generation_;
+				++busyWorkers_;
+			}
+
+			this->RunRanges(iThread);
+
+			{
+				std::lock_guard<std::mutex> lock(mutex_);
+				--busyWorkers_;
+			}
+			doneCondition_.notify_all();
+		}
+	}
+
+
+	void ThreadPool::RunRanges(const UINT64& iThread)
+	{
+		UINT64 begin, end;
+		while (this->TakeRange(iThread, begin, end))
+		{
+			try
+			{
+				(*job_)(iThread, begin, end);
+			}
+			catch (...)
+			{
+				std::lock_guard<std::mutex> lock(mutex_);
+				if (!exception_) exception_ = std::current_exception();
+			}
+
+			if (--pendingRanges_ == 0)
+			{
+				std::lock_guard<std::mutex> lock(mutex_);
+				doneCondition_.notify_all();
+			}
+		}
+	}
+
+
+	bool ThreadPool::TakeRange(const UINT64& iThread, UINT64& begin, UINT64& end)
+	{
+		// own queue first, the front keeps the ranges of a thread in order
+		{
+			WorkQueue& queue = *queues_[iThread];
+			std::lock_guard<std::mutex> lock(queue.mutex);
+			if (!queue.ranges.empty())
+			{
+				begin = queue.ranges.front().first;
+				end = queue.ranges.front().second;
+				queue.ranges.pop_front();
+				return true;
+			}
+		}
+
+		// steal from the back of the other queues, starting with the next thread
+		for (UINT64 i = 1; i < numThreads_; ++i)
+		{
+			WorkQueue& queue = *queues_[(iThread + i) % numThreads_];
+			std::lock_guard<std::mutex> lock(queue.mutex);
+			if (!queue.ranges.empty())
+			{
+				begin = queue.ranges.back().first;
+				end = queue.ranges.back().second;
+				queue.ranges.pop_back();
+				return true;
+			}
+		}
+
+		return false;
+	}
+
+
+	void ThreadPool::Shutdown()
+	{
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			stop_ = true;
+		}
+		workCondition_.notify_all();
+
+		for (auto iter = workers_.begin(); iter != workers_.end(); ++iter)
+		{
+			iter->join();
+		}
+		workers_.clear();
+	}
+
+}